@@ -0,0 +1,41 @@
+#ifndef CHUNKWRITER_H
+#define CHUNKWRITER_H
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+
+/*
+ * Output of unknown length produced in parallel and written in order.
+ *
+ * The output is cut into chunks that are formatted independently, each
+ * into a buffer sized for its longest possible text. The buffers form a
+ * ring of a few per thread: the threads take the chunks in order and
+ * format them as buffers become free, while a writer thread writes every
+ * run of finished chunks in order, with vectored writes (writev) where
+ * available. The threads are started once per call, memory is bounded by
+ * the ring, and the bytes are the same as formatting the chunks one
+ * after another.
+ */
+
+namespace eggp{
+
+struct ChunkSource
+{
+    std::size_t nChunk;
+
+    //* bytes chunk i needs at most
+    std::function<std::size_t(std::size_t)> maxLength;
+
+    //* formats chunk i into out and returns the bytes written
+    std::function<std::size_t(std::size_t, char *)> format;
+};
+
+//* return the number of bytes written
+std::size_t writeChunks(const std::string &filename, const ChunkSource &source, unsigned nThread);
+std::size_t writeChunks(std::ostream &out, const ChunkSource &source, unsigned nThread);
+
+}
+
+#endif // CHUNKWRITER_H
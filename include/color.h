@@ -0,0 +1,36 @@
+#ifndef COLOR_H
+#define COLOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Colors as eggplot keeps them: 0xAARRGGBB with AA the opacity (0xff for
+ * opaque), parsed once when a line color is set. Accepted are
+ *
+ *   gnuplot's color names (as listed by "show colornames"), looked up
+ *   through a perfect hash, and the shortcuts "ymcrgbwk"
+ *   "#rrggbb", "0xrrggbb" and "#aarrggbb", where aa is gnuplot's
+ *   transparency (0x00 for opaque)
+ *   "(r,g,b)" with integers 0-255
+ *   "[r,g,b]" with Matlab's decimals 0.0-1.0, taken as floor(256*v), 1.0 as 255
+ *
+ * Whitespace is ignored. Neither function allocates.
+ */
+
+namespace eggp{
+
+//* longest output of formatColor(), "#aarrggbb"
+const std::size_t maxColorTextLength = 9;
+
+//* false if the color is not recognized
+bool parseColor(const std::string &color, std::uint32_t &argb);
+
+//* "#rrggbb", or "#aarrggbb" in gnuplot's terms if not opaque; writes no
+//* terminating null and returns the number of characters
+std::size_t formatColor(char *out, std::uint32_t argb);
+
+}
+
+#endif // COLOR_H
@@ -11,6 +11,9 @@ enum LineProperty {LineStyle, LineWidth, Marker, MarkerSize, Color};
 typedef std::map<LineProperty, std::string> LineSpecInput;
 
 enum Mode         {SCREEN=1, PNG=2, EPS=4, PDF=8, HTML=16, SVG=32};
+enum Decimation   {NO_DECIMATION, LTTB, MINMAX};
+
+typedef std::vector<double> DataVector;
 
 inline std::vector<double> linspace(double a, double b, unsigned n) {
     std::vector<double> result(n);
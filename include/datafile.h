@@ -0,0 +1,84 @@
+#ifndef DATAFILE_H
+#define DATAFILE_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dataview.h"
+#include "numformat.h"
+
+/*
+ * eggp.dat and inline data, converted on several threads: by curve, and
+ * by pieces within long curves, so that one huge curve is no slower.
+ *
+ * Binary: interleaved float64 (x,y) records, curves back to back; an
+ * empty curve is a single NaN record. The size is known exactly, so a
+ * file is mapped (MappedFile) and every piece is converted straight into
+ * its own region.
+ *
+ * Text: "# Curve i", one "x,y" line per point and two blank lines per
+ * curve. Numbers are written by formatNumber() with digits[i] significant
+ * digits for curve i (0, or a missing entry, for the shortest exact
+ * form). Given a blockName, each curve is a gnuplot datablock
+ * "<blockName>_i << EOD" ... "EOD" instead, for a script to load and plot
+ * curve by curve without rescanning the file. The length of text is not
+ * known in advance: pieces are formatted into buffers of their own and
+ * written in order by writeChunks(), byte for byte as one thread would.
+ *
+ * Columns: curves that share one x (the same view) are written as a single
+ * block x,y1,...,yN instead, read by gnuplot with "using 1:k". Binary rows
+ * are N+1 float64 values, an empty block is a single NaN row; text starts
+ * with a "# Columns" line and x gets the most digits of any curve. Blocks
+ * of rows are converted in parallel.
+ *
+ * The writers return the number of bytes written.
+ */
+
+namespace eggp{
+
+//* digits of an x column shared by curves of the given digits: the most of
+//* any, 0 (exact) if any is
+unsigned sharedDigits(const std::vector<unsigned> &digits);
+
+std::size_t writeDataFileBinary(const std::string &filename,
+                                const std::vector<std::pair<DataView, DataView>> &curves,
+                                unsigned nThread);
+
+std::size_t writeDataFileText(const std::string &filename,
+                              const std::vector<std::pair<DataView, DataView>> &curves,
+                              unsigned nThread,
+                              const std::vector<unsigned> &digits=std::vector<unsigned>(),
+                              const std::string &blockName="");
+
+//* the same text to a stream, for inline data
+std::size_t writeDataStreamText(std::ostream &out,
+                                const std::vector<std::pair<DataView, DataView>> &curves,
+                                unsigned nThread,
+                                const std::vector<unsigned> &digits=std::vector<unsigned>(),
+                                const std::string &blockName="");
+
+//* binary records to a stream, for inline data
+std::size_t writeDataStreamBinary(std::ostream &out,
+                                  const std::vector<std::pair<DataView, DataView>> &curves,
+                                  unsigned nThread);
+
+std::size_t writeDataFileColumnsBinary(const std::string &filename,
+                                       const std::vector<std::pair<DataView, DataView>> &curves,
+                                       unsigned nThread);
+
+std::size_t writeDataFileColumnsText(const std::string &filename,
+                                     const std::vector<std::pair<DataView, DataView>> &curves,
+                                     unsigned nThread,
+                                     const std::vector<unsigned> &digits=std::vector<unsigned>());
+
+std::size_t writeDataStreamColumnsText(std::ostream &out,
+                                       const std::vector<std::pair<DataView, DataView>> &curves,
+                                       unsigned nThread,
+                                       const std::vector<unsigned> &digits=std::vector<unsigned>());
+
+}
+
+#endif // DATAFILE_H
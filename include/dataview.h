@@ -0,0 +1,51 @@
+#ifndef DATAVIEW_H
+#define DATAVIEW_H
+
+#include <cstddef>
+
+#include "common.h"
+
+/*
+ * Non-owning, read-only view of doubles laid out with a constant stride,
+ * e.g. a DataVector, a plain array, one member of an array of structs
+ * (stride = sizeof(struct)/sizeof(double)) or one column of a row-major
+ * matrix (stride = number of columns). The viewed memory must stay valid
+ * until Eggplot::exec() has returned.
+ */
+
+namespace eggp{
+
+class DataView
+{
+public:
+    DataView() : ptr(nullptr), n(0), step(1) {}
+
+    DataView(const DataVector &v) : ptr(v.data()), n(v.size()), step(1) {}
+    DataView(DataVector &&) = delete;  // would dangle
+
+    DataView(const double *data, std::size_t size, std::size_t stride=1)
+        : ptr(data), n(size), step(stride) {}
+
+    //* contiguous ranges only, e.g. iterators of std::vector or std::array
+    template <class Iterator>
+    DataView(Iterator first, Iterator last)
+        : ptr((first==last) ? nullptr : &*first),
+          n(static_cast<std::size_t>(last-first)),
+          step(1) {}
+
+    std::size_t   size()   const { return this->n; }
+    std::size_t   stride() const { return this->step; }
+    const double *data()   const { return this->ptr; }
+    bool          empty()  const { return this->n==0; }
+
+    double operator[](std::size_t i) const { return this->ptr[i*this->step]; }
+
+private:
+    const double *ptr;
+    std::size_t   n;
+    std::size_t   step;
+};
+
+}
+
+#endif // DATAVIEW_H
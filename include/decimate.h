@@ -0,0 +1,33 @@
+#ifndef DECIMATE_H
+#define DECIMATE_H
+
+#include <cstddef>
+
+#include "common.h"
+#include "dataview.h"
+
+/*
+ * Point reduction for long series that keeps what a plot of a given
+ * pixel width can show. Both methods split the series into buckets of
+ * consecutive points, so x is expected to be ordered.
+ *
+ * LTTB:   Largest-Triangle-Three-Buckets, one representative point per
+ *         bucket, chosen to keep the visual shape of the curve.
+ * MinMax: the minimum and maximum of each bucket, in their original
+ *         order, so that no spike is ever dropped.
+ */
+
+namespace eggp{
+
+//* default width in pixels of gnuplot's png, svg and screen terminals
+const unsigned defaultTerminalWidth = 640;
+
+void decimateLttb(const DataView &x, const DataView &y, std::size_t nOut,
+                  DataVector &xOut, DataVector &yOut);
+
+void decimateMinMax(const DataView &x, const DataView &y, std::size_t nBucket,
+                    DataVector &xOut, DataVector &yOut);
+
+}
+
+#endif // DECIMATE_H
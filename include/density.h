@@ -0,0 +1,45 @@
+#ifndef DENSITY_H
+#define DENSITY_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dataview.h"
+
+/*
+ * Point density of scatter plots too large to draw point by point. Every
+ * finite point is counted in a cell of an nx x ny grid spanning the
+ * bounding box of all points, so the size of the result depends on the
+ * grid only. Each thread bins a contiguous share of the points into a
+ * histogram of its own; the histograms are summed at the end, so no cell
+ * is ever written by two threads.
+ */
+
+namespace eggp{
+
+struct DensityGrid
+{
+    unsigned nx;
+    unsigned ny;
+    double   xMin;
+    double   xMax;
+    double   yMin;
+    double   yMax;
+
+    //* ny rows of nx counts, the first at yMin; empty cells are NaN, which
+    //* gnuplot leaves blank
+    std::vector<double> cells;
+};
+
+void binDensity(const std::vector<std::pair<DataView, DataView>> &curves,
+                unsigned nx, unsigned ny, unsigned nThread, DensityGrid &grid);
+
+//* the cells as raw float64, as gnuplot's "binary array=(nx,ny)" reads
+//* them; returns the number of bytes written
+std::size_t writeDensityFile(const std::string &filename, const DensityGrid &grid);
+
+}
+
+#endif // DENSITY_H
@@ -8,9 +8,19 @@
 #include <utility>
 #include <initializer_list>
 #include <fstream>
+#include <memory>
+#include <future>
+#include <chrono>
 
 #include "common.h"
+#include "dataview.h"
+#include "density.h"
+#include "execstats.h"
 #include "linespec.h"
+#include "rendercache.h"
+#include "ringbuffer.h"
+#include "session.h"
+#include "tempdir.h"
 
 /*
  * 1. Markers are mostly the same (up to pt 13) except for terminal aqua.
@@ -30,8 +40,6 @@ namespace eggp{
 
 const std::string version = "0.1.0";
 
-typedef std::vector<double> DataVector;
-
 class Eggplot
 {
 public:
@@ -44,9 +52,37 @@ public:
     void linespec(unsigned lineIndex, LineProperty property, std::string value);
     void linespec(unsigned lineIndex, LineProperty property, double value);
     void grid(bool flag);
+    void binary(bool flag);
+    void precision(unsigned digits);
+    void precision(unsigned lineIndex, unsigned digits);
+    void session(bool flag);
+    void session(std::shared_ptr<GnuplotSession> gnuplotSession);
+    void datablock(bool flag);
+    void threads(unsigned nThread);
+    void native(unsigned mode);
+    void tempdir(const std::string &dir="");
+    void decimate(Decimation method, unsigned nPoint=0);
+    void density(unsigned nBinX, unsigned nBinY, bool isLogScale=false);
+    void cache(const std::string &dir, unsigned long long maxBytes=defaultCacheSize);
     void plot(std::initializer_list<DataVector> il);
+    void plot(std::initializer_list<DataView> il);
+    void plot(const std::vector<DataView> &il);
+    void plot(const DataVector &x, std::initializer_list<DataVector> ys);
+    void plot(const DataView &x, std::initializer_list<DataView> ys);
+    void plot(const double *x, const double *y, std::size_t n,
+              std::size_t strideX=1, std::size_t strideY=1);
+    void envelope(const DataView &x, const std::vector<DataView> &ys,
+                  std::initializer_list<double> quantiles={0.05, 0.25});
+    void envelope(const DataVector &x, const std::vector<DataVector> &ys,
+                  std::initializer_list<double> quantiles={0.05, 0.25});
     void print(const std::string &filenameExport);
+    void stream(std::size_t capacity, double interval=0.1);
+    void append(unsigned lineIndex, double x, double y);
+    void refresh();
     void exec(bool run_gnuplot=true);
+    std::future<void> execAsync();
+    ExecStats stats() const;
+    void trace(const std::string &filename);
 
 private:
     std::string filenamePrefix;
@@ -54,14 +90,59 @@ private:
     std::string labelY;
     std::string labelTitle;
     std::vector<std::string>        legendVec;
+    //* legendVec as given to legend(), padded by prepare() for drawing
+    std::vector<std::string>        curveLegend;
     std::list<std::pair<unsigned, LineSpecInput>> lineSpecInput;
     std::vector<LineSpec>           lineSpec;
     std::list<std::string>          lineSpecAqua;
     std::list<std::string>          lineSpecCanvas;
     std::list<std::string>          lineSpecOther;
+    std::vector<std::pair<DataView, DataView>> curveData;
+    std::vector<DataVector>         ownedData;
+    std::vector<std::pair<DataView, DataView>> renderCurves;
+    std::vector<DataVector>         decimatedData;
+    Decimation decimation;
+    unsigned   nDecimatePoint;
+    unsigned    densityX;
+    unsigned    densityY;
+    bool        isDensityLog;
+    DensityGrid densityGrid;
+    std::vector<bool> isBinnedCurve;
+    //* the first curves of an envelope() are bands, closed polygons
+    unsigned    nBandCurve;
+    std::vector<std::string> envelopeLegend;
+    std::vector<RingBuffer<double>> streamX;
+    std::vector<RingBuffer<double>> streamY;
+    std::size_t streamCapacity;
+    double      streamInterval;
+    std::chrono::steady_clock::time_point lastRefresh;
     unsigned nCurve;
     bool isGridded;
+    bool isBinary;
+    unsigned defaultPrecision;
+    std::map<unsigned, unsigned> curvePrecision;
     std::string filenameExport;
+    std::shared_ptr<TempDir> workDir;
+    std::string workDirParent;
+    std::shared_ptr<GnuplotSession> gnuplotSession;
+    bool isInline;
+    bool hasDatablocks;
+    std::string datablockName;
+    std::string inlineData;
+
+    struct RenderJob {
+        std::string mode;
+        std::string script;
+        std::string filename;
+        bool        isNative;
+    };
+    std::vector<RenderJob> renderJobs;
+    unsigned nThread;
+    unsigned nativeMode;
+    std::shared_ptr<ExecRecorder> recorder;
+    double      probeSeconds;
+    std::string traceFilename;
+    std::shared_ptr<RenderCache> renderCache;
 
     bool flagScreen;
     bool flagHtml;
@@ -76,18 +157,50 @@ private:
     bool existsCairo;
     bool existsSvg;
 
-    bool existsTerminal(std::string);
+    std::string workFile(const std::string &suffix);
+    void ownData();
+    unsigned outputModes() const;
+    bool isNativeOnly(unsigned cachedMode=0) const;
+    bool isColumnar() const;
+    bool isCurveBlocks() const;
+    std::string curveBlock(unsigned iCurve) const;
+    //* gnuplot command dropping the datablocks of this figure, for sessions
+    std::string undefineData() const;
+    void prepare();
     void prepareLineSpec();
+    void prepareData();
+    void prepareDensity();
+    bool isBinned(unsigned iCurve) const;
+    bool isBand(unsigned iCurve) const;
+    void prepareInlineData();
+    void generateJobs(unsigned cachedMode=0);
+    void execStages(bool run_gnuplot, unsigned cachedMode);
+    std::string cacheKey() const;
+    unsigned fetchCached(const std::string &key);
+    void storeCached(const std::string &key, unsigned cachedMode);
+    void release();
+    std::vector<unsigned> curveDigits() const;
+    void writeData();
+    void writeDataText(std::ostream &fout);
+    void writeDataBinary(std::ostream &fout);
+
+    //* generate .gp scripts, queued in renderJobs
+    void gpScreen();
+    void gpPng();
+    void gpEps();
+    void gpPdf();
+    void gpHtml();
+    void gpSvg();
+    void gpHeader(std::ostream &fout);
+    void gpCurve(std::ostream &fout);
+    void gpRun(const RenderJob &job, std::shared_ptr<GnuplotSession> session, bool run_gnuplot) const;
+    void runJobs(bool run_gnuplot);
+    void renderNative(const RenderJob &job) const;
+    std::string inlineScript(const RenderJob &job) const;
 
-    //* plot curve .gp files
-    void gpScreen(bool run_gnuplot);
-    void gpPng(bool run_gnuplot);
-    void gpEps(bool run_gnuplot);
-    void gpPdf(bool run_gnuplot);
-    void gpHtml(bool run_gnuplot);
-    void gpSvg(bool run_gnuplot);
-    void gpHeader(std::ofstream &fout);
-    void gpCurve(std::ofstream &fout, const std::string &filename, bool run_gnuplot);
+    //* all output modes as one inline script, for PlotBatch
+    friend class PlotBatch;
+    std::string batchScript();
 };
 
 }
@@ -0,0 +1,39 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <vector>
+
+#include "common.h"
+#include "dataview.h"
+
+/*
+ * Statistics at every x of many series sampled on the same x, e.g. the
+ * runs of a Monte Carlo simulation, so that they can be drawn as a few
+ * bands instead of one curve each. The series are read a block of x at a
+ * time: a pass along each series updates the sum, minimum and maximum of
+ * the block and copies it into a tile that holds the values of one x next
+ * to each other. The quantiles are then selected from the tile in
+ * ascending order, each one searching only the values above the previous
+ * one. NaNs are skipped; an x without any value gets NaN throughout.
+ */
+
+namespace eggp{
+
+struct EnvelopeStats
+{
+    DataVector mean;
+    DataVector minimum;
+    DataVector maximum;
+
+    //* quantile[k][j] is the quantile levels[k] at x j, interpolated
+    //* linearly between the closest values
+    std::vector<DataVector> quantile;
+};
+
+//* levels must be sorted and lie in [0, 1]; all series have the same size
+void computeEnvelope(const std::vector<DataView> &ys, const std::vector<double> &levels,
+                     unsigned nThread, EnvelopeStats &stats);
+
+}
+
+#endif // ENVELOPE_H
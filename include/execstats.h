@@ -0,0 +1,97 @@
+#ifndef EXECSTATS_H
+#define EXECSTATS_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Where the time of an exec() went.
+ *
+ * ExecStats is the summary: wall time per stage and per output mode, and
+ * what was produced. ExecRecorder collects it from every thread taking
+ * part in an exec(), together with one event per stage and render, which
+ * can be written as a Chrome trace_event file (chrome://tracing or
+ * https://ui.perfetto.dev).
+ */
+
+namespace eggp{
+
+struct ExecStats
+{
+    ExecStats();
+
+    //* seconds
+    double probe;    // waiting in the constructor for the gnuplot probe
+    double cache;    // looking up and storing outputs in the render cache
+    double prepare;  // legends, line specs, decimation
+    double data;     // eggp.dat or the inline datablock
+    double script;   // gnuplot scripts of all output modes
+    double render;   // all output modes, from first start to last finish
+    double total;    // exec() as a whole
+    std::map<std::string, double> modes;  // per output mode, e.g. "PNG"
+
+    unsigned long long bytesWritten;      // to files and to gnuplot's stdin
+    unsigned long long pointsSerialized;  // (x,y) points written as text or binary
+    unsigned           processesSpawned;  // gnuplot processes started
+    unsigned           cacheHits;         // output modes copied from the render cache
+};
+
+class ExecRecorder
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit ExecRecorder(double probe=0);
+
+    //* adds the time since begin to a stage of ExecStats
+    void stage(double ExecStats::*field, const std::string &name, Clock::time_point begin);
+    void mode(const std::string &name, Clock::time_point begin);
+
+    void addBytes(unsigned long long nByte);
+    void addPoints(unsigned long long nPoint);
+    void addProcesses(unsigned nProcess);
+    void addCacheHits(unsigned nHit);
+
+    ExecStats stats() const;
+    void writeTrace(const std::string &filename) const;
+
+    //* times a stage from construction to the end of the scope
+    class Scope
+    {
+    public:
+        Scope(ExecRecorder &recorder, double ExecStats::*field, const std::string &name);
+        ~Scope();
+    private:
+        ExecRecorder      &recorder;
+        double ExecStats::*field;
+        std::string        name;
+        Clock::time_point  begin;
+    };
+
+private:
+    struct Event {
+        std::string name;
+        std::string category;
+        double      begin;     // microseconds since the recorder was created
+        double      duration;  // microseconds
+        unsigned    thread;
+    };
+
+    mutable std::mutex mutex;
+    ExecStats          summary;
+    std::vector<Event> events;
+    std::vector<std::thread::id> threads;
+    Clock::time_point  origin;
+    long long          originEpoch;  // origin in microseconds since the Unix epoch
+
+    void addEvent(const std::string &name, const std::string &category, Clock::time_point begin,
+                  Clock::time_point end);
+};
+
+}
+
+#endif // EXECSTATS_H
@@ -0,0 +1,76 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dataview.h"
+#include "linespec.h"
+
+/*
+ * Everything a native backend needs to draw a figure, and the plot frame
+ * it is drawn in: autoscaled axes with gnuplot-like "nice" tick steps
+ * (1, 2 or 5 times a power of ten, range extended to whole ticks) and
+ * the mapping from data to pixel coordinates.
+ */
+
+namespace eggp{
+
+//* fill opacity of the bands of Eggplot::envelope(), as gnuplot's
+//* "fs transparent solid"
+const double bandOpacity = 0.2;
+
+//* the color of a band over the color of its median line
+inline std::uint32_t bandColor(std::uint32_t argb)
+{
+    return (static_cast<std::uint32_t>((argb >> 24)*bandOpacity + 0.5) << 24) | (argb & 0xffffffu);
+}
+
+struct FigureSpec
+{
+    std::vector<std::pair<DataView, DataView>> curves;
+    //* the first nBand curves are closed polygons filled with bandColor()
+    //* of the curve right after them
+    unsigned    nBand;
+    std::vector<LineSpec>    lineSpec;
+    std::vector<std::string> legend;
+    std::string title;
+    std::string xlabel;
+    std::string ylabel;
+    bool        isGridded;
+};
+
+struct Axis
+{
+    double lo;
+    double hi;
+    double step;
+
+    std::vector<double> ticks() const;
+    std::string tickLabel(double value) const;
+};
+
+//* range of [lo, hi] rounded out to nice ticks, about maxTicks of them
+Axis niceAxis(double lo, double hi, unsigned maxTicks=8);
+
+class Frame
+{
+public:
+    Frame(const FigureSpec &figure, unsigned width, unsigned height);
+
+    Axis   x;
+    Axis   y;
+    double left;
+    double right;
+    double top;
+    double bottom;
+
+    double toPixelX(double value) const { return left + (value-x.lo)/(x.hi-x.lo)*(right-left); }
+    double toPixelY(double value) const { return bottom - (value-y.lo)/(y.hi-y.lo)*(bottom-top); }
+};
+
+}
+
+#endif // FRAME_H
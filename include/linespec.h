@@ -1,65 +1,68 @@
 #ifndef LINESPEC_H
 #define LINESPEC_H
 
+#include <cstdint>
 #include <string>
-#include <map>
-#include <vector>
 #include <utility>
 
 #include "common.h"
 
 namespace eggp{
 
-enum TerminalType {TERM_AQUA, TERM_WXT, TERM_CAIRO, TERM_SVG, TERM_CANVAS, TERM_OTHER};
+enum TerminalType {TERM_AQUA, TERM_WXT, TERM_CAIRO, TERM_SVG, TERM_CANVAS, TERM_OTHER,
+                   TERMINAL_TYPE_COUNT};
+
+//* LineStyle "-", "--", ":", "-." and "none"
+enum LineType {LINE_SOLID, LINE_DASHED, LINE_DOTTED, LINE_DASHDOT, LINE_NONE, LINE_TYPE_COUNT};
+
+//* Marker "o+*.xsd^v><ph" (or their long names) and "none"; MARKER_DEFAULT
+//* uses the point type numbered as the line
+enum MarkerType {MARKER_DEFAULT, MARKER_CIRCLE, MARKER_PLUS, MARKER_STAR, MARKER_POINT,
+                 MARKER_CROSS, MARKER_SQUARE, MARKER_DIAMOND, MARKER_UP, MARKER_DOWN,
+                 MARKER_RIGHT, MARKER_LEFT, MARKER_PENTAGRAM, MARKER_HEXAGRAM, MARKER_NONE,
+                 MARKER_TYPE_COUNT};
+
+//* A LineSpec resolved for drawing: plain values, no allocation. Every
+//* terminal formats from this record through its tables.
+struct LineStyleRecord
+{
+    unsigned   index;
+    LineType   lineType;
+    MarkerType marker;
+    double     lineWidth;
+    double     pointSize;
+    //* 0xAARRGGBB with AA the opacity, see color.h
+    std::uint32_t color;
+};
 
 class LineSpec {
 public:
-    LineSpec(unsigned index=0);
+    explicit LineSpec(unsigned index);
 
+    //* properties are checked and resolved here, once
     void set(const LineProperty property, const std::string &value);
     void set(const std::pair<LineProperty, std::string> &input);
 
+    //* "set style line" command for the terminal type
+    std::string toString(TerminalType tt) const;
     std::string toStringAqua() const;
     std::string toStringWxtCairoSvg() const;
     std::string toStringHtml() const;
 
+    //* resolved properties, for backends that draw without gnuplot
+    const LineStyleRecord &style() const { return this->record; }
+    std::string getColor() const;
+    double      getLineWidth() const;
+    double      getPointSize() const;
+    LineType    getLineType() const;
+    int         getPointType(TerminalType tt) const;
+
     bool isPointOnly() const;
     static unsigned getGridLineType(TerminalType tt);
-    static std::string gridColor;
-
-    //* static function
-    static void resetLineCount();
+    static const std::string gridColor;
 
 private:
-    unsigned    lineIndex;
-    std::string lineType;
-    double      lineWidth;
-    std::string pointType;
-    double      pointSize;
-    std::string color;
-
-    void toStringBasic(const std::map<std::string, int> &lineTypeMapping,
-                       const std::map<std::string, int> &pointTypeMapping,
-                       std::string                      &style) const;
-
-    //* default color
-    static const std::vector<std::string> defaultColor;
-
-    //* line type mapping
-    static const std::map<std::string, int> lineTypeMappingAqua;
-    static const std::map<std::string, int> lineTypeMappingOther;
-
-    //* point type mapping
-    static const std::map<std::string, int> pointTypeMappingAqua;
-    static const std::map<std::string, int> pointTypeMappingCanvas;
-    static const std::map<std::string, int> pointTypeMappingOther;
-
-    //* color shortcut
-    static const std::map<char, std::string> colorShortCutMapping;
-
-    //* static index
-    static unsigned lineCount;
-
+    LineStyleRecord record;
 };
 
 }
@@ -0,0 +1,48 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * An output file of known maximum size, preallocated and mapped into
+ * memory so that it is filled in place, without stream buffers or write
+ * calls. Disjoint regions may be written from different threads. On
+ * close the file is cut to the size actually used.
+ *
+ * Where mapping is not available (Windows), the data is collected in
+ * memory and written on close.
+ */
+
+namespace eggp{
+
+class MappedFile
+{
+public:
+    MappedFile(const std::string &filename, std::size_t capacity);
+    ~MappedFile();
+
+    char *data();
+    std::size_t capacity() const;
+
+    //* unmaps and cuts the file to size bytes; throws on failure
+    void close(std::size_t size);
+
+private:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    std::string filename;
+    std::size_t nCapacity;
+    char       *address;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#else
+    int         fd;
+#endif
+};
+
+}
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,35 @@
+#ifndef NUMFORMAT_H
+#define NUMFORMAT_H
+
+#include <cstddef>
+
+/*
+ * Locale-independent double to text conversion for data files.
+ *
+ * With digits 0 the result is the shortest decimal string that reads back
+ * as the very same double (Grisu2, F. Loitsch, "Printing Floating-Point
+ * Numbers Quickly and Accurately with Integers", PLDI 2010; in rare cases
+ * one digit longer than necessary, never inexact). Otherwise the value is
+ * rounded half up from those digits to at most that many significant digits,
+ * with the notation chosen as printf's %g does.
+ *
+ * Shortest numbers with a decimal exponent in [-5, 15] are written in fixed
+ * notation ("1712345678.25", "0.000125"), others in scientific notation
+ * with at least two exponent digits ("1.5e+300"). Non-finite values are
+ * "nan", "inf" and "-inf".
+ */
+
+namespace eggp{
+
+//* longest output, e.g. "-1.2345678901234567e-308"
+const std::size_t maxNumberLength = 24;
+
+//* most significant digits ever needed to read back a double exactly
+const unsigned maxPrecision = 17;
+
+//* writes no terminating null; returns the number of characters
+std::size_t formatNumber(char *out, double value, unsigned digits=0);
+
+}
+
+#endif // NUMFORMAT_H
@@ -0,0 +1,19 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace eggp{
+
+//* Number of threads used when none is specified (at least 1)
+unsigned defaultThreadCount();
+
+//* Call task(i) for every i in [0, n) on at most nThread threads, the
+//* calling thread included. The first exception thrown by a task is
+//* rethrown after all threads have finished.
+void parallelFor(std::size_t n, unsigned nThread, const std::function<void(std::size_t)> &task);
+
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,37 @@
+#ifndef PLOTBATCH_H
+#define PLOTBATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "eggplot.h"
+
+/*
+ * Renders many figures with a few gnuplot processes.
+ *
+ * add() turns a fully configured figure into an inline script right away
+ * (the figure and its data may be discarded afterwards). exec() joins the
+ * scripts into one per process, each switching `set output` and
+ * re-plotting figure after figure, and runs the processes in parallel.
+ */
+
+namespace eggp{
+
+class PlotBatch
+{
+public:
+    explicit PlotBatch(unsigned nProcess=1);
+
+    void add(const Eggplot &figure);
+    std::size_t size() const;
+    void exec(bool run_gnuplot=true);
+
+private:
+    unsigned                 nProcess;
+    std::vector<std::string> scripts;
+};
+
+}
+
+#endif // PLOTBATCH_H
@@ -0,0 +1,23 @@
+#ifndef PNGENCODER_H
+#define PNGENCODER_H
+
+#include <ostream>
+
+/*
+ * Minimal PNG encoder for 8-bit RGBA images, written as RGB if opaque.
+ *
+ * Each row takes the cheapest of PNG's None, Sub and Up filters, and the
+ * result is deflated as a single fixed-Huffman block with a greedy LZ77
+ * matcher. Plots are mostly flat background, which filters to long runs
+ * of zeros, so this gets close to zlib's default level at a fraction of
+ * the code.
+ */
+
+namespace eggp{
+
+void encodePng(std::ostream &out, const unsigned char *rgba,
+               unsigned width, unsigned height);
+
+}
+
+#endif // PNGENCODER_H
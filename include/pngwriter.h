@@ -0,0 +1,21 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include <ostream>
+
+#include "frame.h"
+
+/*
+ * Native PNG backend: rasterizes a figure in-process with anti-aliased
+ * lines and markers and encodes it as PNG, without gnuplot. Labels use a
+ * built-in bitmap font; enhanced text markup is drawn as plain text.
+ */
+
+namespace eggp{
+
+void writePng(std::ostream &out, const FigureSpec &figure,
+              unsigned width=640, unsigned height=480);
+
+}
+
+#endif // PNGWRITER_H
@@ -0,0 +1,81 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * RGBA canvas with anti-aliased drawing for the native PNG backend.
+ *
+ * Colors are 0xAARRGGBB (see color.h). Lines are drawn as capsules whose
+ * coverage is the distance of each pixel center to the segment, so any
+ * width and slope gets the same smooth edge; only the pixels of a few
+ * spans around each segment are visited. Markers are rasterized once per
+ * curve into a coverage stamp and blended at every point. Solid areas
+ * are filled as horizontal spans of contiguous pixels; polygons with four
+ * scanlines per pixel row, each crossing only the edges active on it. Text uses a
+ * built-in 5x7 bitmap font for printable ASCII.
+ */
+
+namespace eggp{
+
+enum TextAlign {ALIGN_LEFT, ALIGN_CENTER, ALIGN_RIGHT};
+
+class Raster
+{
+public:
+    Raster(unsigned width, unsigned height, std::uint32_t background=0xffffffff);
+
+    unsigned width() const  { return this->nWidth; }
+    unsigned height() const { return this->nHeight; }
+
+    //* RGBA bytes, row by row from the top
+    const std::vector<unsigned char> &pixels() const { return this->rgba; }
+
+    //* drawing outside of the clip rectangle is discarded
+    void clip(double left, double top, double right, double bottom);
+    void unclip();
+
+    //* pixel-aligned rectangle, edges rounded to the nearest pixel
+    void fillRect(double left, double top, double right, double bottom, std::uint32_t color);
+
+    void strokeLine(double x0, double y0, double x1, double y1, double lineWidth, std::uint32_t color);
+
+    //* dash holds alternating on and off lengths in pixels, empty for solid
+    void strokePolyline(const double *x, const double *y, std::size_t n, double lineWidth,
+                        std::uint32_t color, const std::vector<double> &dash=std::vector<double>());
+
+    //* closed polygon, filled by the even-odd rule; points that are not
+    //* finite are left out
+    void fillPolygon(const double *x, const double *y, std::size_t n, std::uint32_t color);
+
+    //* pointType as gnuplot's point types 1-15 of the cairo terminals
+    void drawMarkers(const double *x, const double *y, std::size_t n,
+                     int pointType, double radius, std::uint32_t color);
+
+    //* y is the vertical center of the text; vertical text reads upwards
+    void drawText(double x, double y, const std::string &text, std::uint32_t color,
+                  TextAlign align=ALIGN_LEFT, bool isVertical=false);
+    static double textWidth(const std::string &text);
+    static double textHeight();
+
+private:
+    unsigned nWidth;
+    unsigned nHeight;
+    std::vector<unsigned char> rgba;
+
+    int clipLeft;
+    int clipTop;
+    int clipRight;
+    int clipBottom;
+
+    void blendSpan(int row, int begin, int end, std::uint32_t color, unsigned alpha);
+    void strokeSegment(double x0, double y0, double x1, double y1,
+                       double halfWidth, std::uint32_t color, unsigned alpha);
+};
+
+}
+
+#endif // RASTER_H
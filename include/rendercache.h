@@ -0,0 +1,74 @@
+#ifndef RENDERCACHE_H
+#define RENDERCACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "dataview.h"
+
+/*
+ * Rendered figures kept on disk under a key of everything that went into
+ * them, so that an unchanged figure is copied instead of rendered again.
+ *
+ * Entries are plain files named by their key in the cache directory.
+ * They are written aside and renamed, so concurrent processes never see
+ * half a file. A hit refreshes the modification time of the entry; after
+ * every store the least recently used entries are removed until the
+ * directory is within its size bound. Entries are copied both ways rather
+ * than hard-linked: a link would let the next gnuplot run, which
+ * truncates its output file, overwrite the cached copy as well.
+ */
+
+namespace eggp{
+
+const unsigned long long defaultCacheSize = 256ull << 20;
+
+//* 64-bit hash of a sequence of values after MurmurHash64A, not cryptographic
+class Hasher
+{
+public:
+    Hasher();
+
+    void add(std::uint64_t value);
+    void add(double value);
+    void add(const std::string &text);
+    void add(const DataView &data);
+
+    std::uint64_t digest() const;
+    //* digest as 16 hex digits
+    std::string hex() const;
+
+private:
+    std::uint64_t state;
+    std::uint64_t length;
+};
+
+class RenderCache
+{
+public:
+    //* creates dir if it does not exist
+    RenderCache(const std::string &dir, unsigned long long maxBytes);
+
+    const std::string &path() const;
+    unsigned long long capacity() const;
+
+    //* copies the entry of key to filename; false if there is none
+    bool fetch(const std::string &key, const std::string &filename) const;
+
+    //* keeps a copy of filename as the entry of key, then evicts
+    void store(const std::string &key, const std::string &filename);
+
+    //* removes every entry
+    void clear();
+
+private:
+    std::string        dirname;
+    unsigned long long maxBytes;
+
+    std::string entry(const std::string &key) const;
+    void evict();
+};
+
+}
+
+#endif // RENDERCACHE_H
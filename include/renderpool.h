@@ -0,0 +1,59 @@
+#ifndef RENDERPOOL_H
+#define RENDERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Process-wide pool of render workers behind Eggplot::execAsync().
+ *
+ * At most `concurrency` tasks run at a time and at most `queueDepth` wait;
+ * submit() blocks while the queue is full, so a producer that outpaces
+ * the renderers is slowed down instead of piling up figures in memory.
+ * Pending tasks are finished before the process exits.
+ */
+
+namespace eggp{
+
+class RenderPool
+{
+public:
+    static RenderPool &instance();
+
+    void configure(unsigned concurrency, std::size_t queueDepth);
+    std::future<void> submit(const std::function<void()> &task);
+    void wait();
+
+    ~RenderPool();
+
+private:
+    RenderPool();
+    RenderPool(const RenderPool &) = delete;
+    RenderPool &operator=(const RenderPool &) = delete;
+
+    typedef std::shared_ptr<std::packaged_task<void()>> Task;
+
+    std::vector<std::thread> workers;
+    std::deque<Task>         queue;
+    std::mutex               mutex;
+    std::condition_variable  hasTask;
+    std::condition_variable  hasRoom;
+    std::condition_variable  isIdle;
+    unsigned    concurrency;
+    std::size_t queueDepth;
+    unsigned    nBusy;
+    bool        isStopping;
+
+    void worker();
+};
+
+}
+
+#endif // RENDERPOOL_H
@@ -0,0 +1,67 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Fixed-capacity FIFO: once full, every push overwrites the oldest
+ * element. Element 0 is the oldest one kept.
+ */
+
+namespace eggp{
+
+template <class T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(std::size_t capacity)
+        : buffer(capacity), head(0), count(0)
+    {
+        if (capacity==0) {
+            throw std::invalid_argument("Ring buffer capacity must be positive");
+        }
+    }
+
+    void push(const T &value)
+    {
+        this->buffer[(this->head+this->count) % this->buffer.size()] = value;
+        if (this->count < this->buffer.size()) {
+            ++(this->count);
+        }
+        else {
+            this->head = (this->head+1) % this->buffer.size();
+        }
+    }
+
+    const T &operator[](std::size_t i) const
+    {
+        return this->buffer[(this->head+i) % this->buffer.size()];
+    }
+
+    //* copy out oldest first, reusing the storage of out
+    void copyTo(std::vector<T> &out) const
+    {
+        std::size_t first = this->buffer.size() - this->head;
+        if (first > this->count) {
+            first = this->count;
+        }
+        out.assign(this->buffer.begin()+this->head, this->buffer.begin()+this->head+first);
+        out.insert(out.end(), this->buffer.begin(), this->buffer.begin()+(this->count-first));
+    }
+
+    std::size_t size()     const { return this->count; }
+    std::size_t capacity() const { return this->buffer.size(); }
+    bool        empty()    const { return this->count==0; }
+    void        clear()          { this->head = 0; this->count = 0; }
+
+private:
+    std::vector<T> buffer;
+    std::size_t    head;
+    std::size_t    count;
+};
+
+}
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,63 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*
+ * A long-lived gnuplot process fed through a pipe.
+ *
+ * Scripts are written to gnuplot's stdin and run() blocks until gnuplot has
+ * processed them, which is detected by a marker printed back on stderr.
+ * Everything gnuplot prints before the marker (warnings, errors) is kept
+ * and can be read with messages(). A session may be shared by several
+ * Eggplot objects and threads; scripts never interleave.
+ */
+
+namespace eggp{
+
+class GnuplotSession
+{
+public:
+    explicit GnuplotSession(const std::string &command="gnuplot");
+    ~GnuplotSession();
+
+    void run(const std::string &script);
+    std::string messages() const;
+
+    //* gnuplot processes started so far, restarts after a crash included
+    unsigned long processCount() const;
+
+    //* process-wide session shared by all figures that ask for it
+    static std::shared_ptr<GnuplotSession> shared();
+
+private:
+    GnuplotSession(const GnuplotSession &) = delete;
+    GnuplotSession &operator=(const GnuplotSession &) = delete;
+
+    std::string        command;
+    std::string        lastMessages;
+    mutable std::mutex mutex;
+    unsigned long      syncCount;
+    unsigned long      startCount;
+
+#ifdef _WIN32
+    FILE *pipe;
+#else
+    int  pid;
+    int  fdIn;
+    int  fdErr;
+#endif
+
+    bool isRunning() const;
+    void start();
+    void stop();
+    bool write(const std::string &data);
+    bool waitFor(const std::string &marker);
+};
+
+}
+
+#endif // SESSION_H
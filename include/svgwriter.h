@@ -0,0 +1,22 @@
+#ifndef SVGWRITER_H
+#define SVGWRITER_H
+
+#include <ostream>
+
+#include "frame.h"
+
+/*
+ * Native SVG backend: draws a figure directly from the curves and their
+ * resolved LineSpec styles, without gnuplot. Dashed lines are supported
+ * (unlike gnuplot's svg terminal); enhanced text markup in labels is
+ * written as plain text.
+ */
+
+namespace eggp{
+
+void writeSvg(std::ostream &out, const FigureSpec &figure,
+              unsigned width=600, unsigned height=480);
+
+}
+
+#endif // SVGWRITER_H
@@ -0,0 +1,39 @@
+#ifndef TEMPDIR_H
+#define TEMPDIR_H
+
+#include <mutex>
+#include <set>
+#include <string>
+
+/*
+ * A uniquely named working directory, created under a parent directory
+ * with a mkdtemp-style random suffix. Files handed out by file() are
+ * removed together with the directory on destruction.
+ */
+
+namespace eggp{
+
+class TempDir
+{
+public:
+    explicit TempDir(const std::string &parent="");
+    ~TempDir();
+
+    const std::string &path() const;
+    std::string file(const std::string &name);
+
+    //* $TMPDIR (or the platform equivalent), /tmp otherwise
+    static std::string systemTempDir();
+
+private:
+    TempDir(const TempDir &) = delete;
+    TempDir &operator=(const TempDir &) = delete;
+
+    std::string           dirname;
+    std::set<std::string> files;
+    std::mutex            mutex;
+};
+
+}
+
+#endif // TEMPDIR_H
@@ -0,0 +1,44 @@
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#include <string>
+
+/*
+ * Terminals and version of the gnuplot found in $PATH.
+ *
+ * gnuplot is asked once per process, in a single invocation, for
+ * GPVAL_TERMINALS and GPVAL_VERSION. If a cache file is set before the
+ * first query, the answer is also kept on disk together with the path and
+ * modification time of the gnuplot binary, so later processes can skip
+ * the probe until gnuplot is replaced.
+ */
+
+namespace eggp{
+
+class TerminalProbe
+{
+public:
+    static const TerminalProbe &instance();
+    static void cacheFile(const std::string &filename);
+
+    bool hasTerminal(const std::string &name) const;
+    const std::string &terminals() const;
+    const std::string &version() const;
+
+private:
+    TerminalProbe();
+
+    std::string terminalList;
+    std::string gnuplotVersion;
+
+    static std::string findExecutable(const std::string &name);
+    static std::string cacheFilename;
+
+    bool readCache(const std::string &key);
+    void writeCache(const std::string &key) const;
+    void probe();
+};
+
+}
+
+#endif // TERMINAL_H
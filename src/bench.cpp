@@ -0,0 +1,603 @@
+/*
+ * Benchmarks of eggplot, written as JSON to stdout or to the file given as
+ * the first argument:
+ *
+ *   serialize   plot() + exec(false): data file and scripts, text and binary
+ *   sharedx     the same for curves sharing one x, as x,y pairs and as
+ *               columns with plot(x, {y1, y2, ...})
+ *   density     plot() + exec(false) of a point-only scatter plot, point
+ *               by point and binned by density() into a 640x480 image
+ *   envelope    plot() + exec(false) of thousands of random walks on one x,
+ *               as one curve each and reduced by envelope() to bands
+ *   linespec    gnuplot line styles generated for thousands of curves
+ *   terminal    the one-time gnuplot probe and the Eggplot constructor
+ *   exec        exec() latency per output mode, with a stub gnuplot that
+ *               does nothing (process and I/O overhead only) and with the
+ *               gnuplot in $PATH, if any
+ *   cache       exec() of an unchanged figure served from the render cache,
+ *               against rendering it with the native backends
+ *   manycurves  gnuplot rendering thousands of text curves from per-curve
+ *               datablocks, against the same data as sets read by "index",
+ *               if gnuplot 5.0 or above is in $PATH
+ *
+ * Every figure is the median of several runs on fixed, generated data.
+ * Everything is written into a scratch directory that is removed at exit.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #define chdir  _chdir
+    #define getcwd _getcwd
+    #define rmdir  _rmdir
+#else
+    #include <unistd.h>
+#endif
+
+#include "eggplot.h"
+#include "linespec.h"
+#include "rendercache.h"
+#include "tempdir.h"
+#include "terminal.h"
+
+using namespace std;
+using namespace eggp;
+
+namespace {
+
+struct Result
+{
+    string name;
+    vector<pair<string, string>> labels;
+    vector<pair<string, double>> metrics;
+};
+
+vector<Result> results;
+
+double seconds(chrono::steady_clock::time_point begin)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+//* median wall time in seconds of repeat calls
+double timeMedian(unsigned repeat, const function<void()> &task)
+{
+    vector<double> times;
+    for (unsigned i=0; i<repeat; ++i) {
+        auto begin = chrono::steady_clock::now();
+        task();
+        times.push_back(seconds(begin));
+    }
+    sort(times.begin(), times.end());
+    return times[times.size()/2];
+}
+
+long long fileSize(const string &filename)
+{
+    struct stat st;
+    return (stat(filename.c_str(), &st)==0) ? static_cast<long long>(st.st_size) : 0;
+}
+
+string jsonString(const string &text)
+{
+    string result = "\"";
+    for (auto it=text.begin(); it!=text.end(); ++it) {
+        switch (*it) {
+        case '"':  result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n";  break;
+        default:   result += *it;
+        }
+    }
+    return result + "\"";
+}
+
+void writeJson(ostream &out)
+{
+    char timestamp[32];
+    time_t now = time(nullptr);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    out << "{\n"
+        << "  \"timestamp\": " << jsonString(timestamp) << ",\n"
+        << "  \"gnuplot\": " << jsonString(TerminalProbe::instance().version()) << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i=0; i<results.size(); ++i) {
+        const Result &result = results[i];
+        out << "    {\"name\": " << jsonString(result.name);
+        for (auto it=result.labels.begin(); it!=result.labels.end(); ++it) {
+            out << ", " << jsonString(it->first) << ": " << jsonString(it->second);
+        }
+        for (auto it=result.metrics.begin(); it!=result.metrics.end(); ++it) {
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%.10g", it->second);
+            out << ", " << jsonString(it->first) << ": " << buffer;
+        }
+        out << ((i+1 < results.size()) ? "},\n" : "}\n");
+    }
+    out << "  ]\n"
+        << "}\n";
+}
+
+//* nCurve series of nPoint points each, the same on every run
+void makeData(unsigned nCurve, size_t nPoint, vector<DataVector> &data)
+{
+    data.clear();
+    DataVector x = linspace(0, 10, nPoint);
+    for (unsigned k=0; k<nCurve; ++k) {
+        DataVector y(nPoint);
+        for (size_t i=0; i<nPoint; ++i) {
+            y[i] = sin(x[i] + k) * exp(-0.1*x[i]);
+        }
+        data.push_back(x);
+        data.push_back(y);
+    }
+}
+
+void plotAll(Eggplot &figure, const vector<DataVector> &data)
+{
+    figure.plot(vector<DataView>(data.begin(), data.end()));
+}
+
+void benchTerminal()
+{
+    //* must run first: the probe happens once per process
+    Result cold;
+    cold.name = "terminal/probe";
+    auto begin = chrono::steady_clock::now();
+    TerminalProbe::instance();
+    cold.metrics.push_back(make_pair("seconds", seconds(begin)));
+    results.push_back(cold);
+
+    const unsigned nObject = 1000;
+    Result warm;
+    warm.name = "terminal/constructor";
+    double time = timeMedian(5, [&]() {
+        for (unsigned i=0; i<nObject; ++i) {
+            Eggplot figure(PNG);
+        }
+    });
+    warm.metrics.push_back(make_pair("seconds", time/nObject));
+    results.push_back(warm);
+}
+
+void benchSerialize()
+{
+    const size_t   sizes[]  = {1000, 10000, 100000, 1000000};
+    const unsigned curves[] = {1, 10};
+    vector<DataVector> data;
+
+    for (int isBinary=0; isBinary<2; ++isBinary) {
+        for (unsigned iSize=0; iSize<sizeof(sizes)/sizeof(sizes[0]); ++iSize) {
+            for (unsigned iCurve=0; iCurve<sizeof(curves)/sizeof(curves[0]); ++iCurve) {
+                const size_t   nPoint = sizes[iSize];
+                const unsigned nCurve = curves[iCurve];
+                const double   nTotal = static_cast<double>(nPoint)*nCurve;
+                makeData(nCurve, nPoint, data);
+
+                //* about a second per case, at least three runs
+                unsigned repeat = static_cast<unsigned>(max(3.0, min(20.0, 2e6/nTotal)));
+                double time = timeMedian(repeat, [&]() {
+                    Eggplot figure(PNG);
+                    figure.binary(isBinary!=0);
+                    plotAll(figure, data);
+                    figure.exec(false);
+                });
+                double bytes = static_cast<double>(fileSize("eggp.dat"));
+
+                Result result;
+                result.name = "serialize";
+                result.labels.push_back(make_pair("format", isBinary ? "binary" : "text"));
+                result.metrics.push_back(make_pair("curves", nCurve));
+                result.metrics.push_back(make_pair("points", nPoint));
+                result.metrics.push_back(make_pair("seconds", time));
+                result.metrics.push_back(make_pair("bytes", bytes));
+                result.metrics.push_back(make_pair("points_per_sec", nTotal/time));
+                result.metrics.push_back(make_pair("bytes_per_sec", bytes/time));
+                results.push_back(result);
+            }
+        }
+    }
+}
+
+void benchSharedX()
+{
+    const unsigned nCurve = 10;
+    const size_t   nPoint = 100000;
+    DataVector x = linspace(0, 10, nPoint);
+    vector<DataVector> y(nCurve, DataVector(nPoint));
+    vector<DataVector> pairs;
+    for (unsigned k=0; k<nCurve; ++k) {
+        for (size_t i=0; i<nPoint; ++i) {
+            y[k][i] = sin(x[i] + k) * exp(-0.1*x[i]);
+        }
+        pairs.push_back(x);
+        pairs.push_back(y[k]);
+    }
+
+    for (int isBinary=0; isBinary<2; ++isBinary) {
+        for (int isColumnar=0; isColumnar<2; ++isColumnar) {
+            double time = timeMedian(5, [&]() {
+                Eggplot figure(PNG);
+                figure.binary(isBinary!=0);
+                if (isColumnar) {
+                    //* views, as plotAll() passes them
+                    const vector<DataView> v(y.begin(), y.end());
+                    figure.plot(DataView(x), {v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9]});
+                }
+                else {
+                    plotAll(figure, pairs);
+                }
+                figure.exec(false);
+            });
+            double bytes = static_cast<double>(fileSize("eggp.dat"));
+
+            Result result;
+            result.name = "sharedx";
+            result.labels.push_back(make_pair("format", isBinary ? "binary" : "text"));
+            result.labels.push_back(make_pair("layout", isColumnar ? "columns" : "pairs"));
+            result.metrics.push_back(make_pair("curves", nCurve));
+            result.metrics.push_back(make_pair("points", nPoint));
+            result.metrics.push_back(make_pair("seconds", time));
+            result.metrics.push_back(make_pair("bytes", bytes));
+            results.push_back(result);
+        }
+    }
+}
+
+void benchDensity()
+{
+    const size_t sizes[] = {1000000, 10000000};
+    for (unsigned iSize=0; iSize<sizeof(sizes)/sizeof(sizes[0]); ++iSize) {
+        const size_t nPoint = sizes[iSize];
+        DataVector x(nPoint);
+        DataVector y(nPoint);
+        for (size_t i=0; i<nPoint; ++i) {
+            x[i] = sin(0.7*i) + 0.3*sin(0.013*i);
+            y[i] = cos(1.3*i) * x[i];
+        }
+
+        for (int isBinned=0; isBinned<2; ++isBinned) {
+            double time = timeMedian(3, [&]() {
+                Eggplot figure(PNG);
+                figure.linespec(1, LineStyle, "none");
+                if (isBinned) {
+                    figure.density(640, 480);
+                }
+                figure.plot({DataView(x), DataView(y)});
+                figure.exec(false);
+            });
+            double bytes = static_cast<double>(fileSize("eggp.dat"));
+            if (isBinned) {
+                bytes += static_cast<double>(fileSize("eggp-density.dat"));
+            }
+
+            Result result;
+            result.name = "density";
+            result.labels.push_back(make_pair("layout", isBinned ? "image" : "points"));
+            result.metrics.push_back(make_pair("points", nPoint));
+            result.metrics.push_back(make_pair("seconds", time));
+            result.metrics.push_back(make_pair("bytes", bytes));
+            results.push_back(result);
+        }
+    }
+}
+
+void benchEnvelope()
+{
+    const unsigned counts[] = {1000, 10000};
+    const size_t nPoint = 1000;
+    DataVector x = linspace(0, 1, nPoint);
+    for (unsigned iCount=0; iCount<sizeof(counts)/sizeof(counts[0]); ++iCount) {
+        const unsigned nRun = counts[iCount];
+        vector<DataVector> runs(nRun, DataVector(nPoint));
+        unsigned long long state = 1;
+        for (unsigned k=0; k<nRun; ++k) {
+            double y = 0;
+            for (size_t i=0; i<nPoint; ++i) {
+                state = state*6364136223846793005ULL + 1442695040888963407ULL;
+                y += static_cast<double>(state >> 11)/9007199254740992.0 - 0.5;
+                runs[k][i] = y;
+            }
+        }
+
+        for (int isEnvelope=0; isEnvelope<2; ++isEnvelope) {
+            double time = timeMedian(3, [&]() {
+                Eggplot figure(PNG);
+                if (isEnvelope) {
+                    figure.envelope(x, runs);
+                }
+                else {
+                    vector<DataView> curves;
+                    for (auto it=runs.begin(); it!=runs.end(); ++it) {
+                        curves.push_back(DataView(x));
+                        curves.push_back(DataView(*it));
+                    }
+                    figure.plot(curves);
+                }
+                figure.exec(false);
+            });
+
+            Result result;
+            result.name = "envelope";
+            result.labels.push_back(make_pair("layout", isEnvelope ? "bands" : "curves"));
+            result.metrics.push_back(make_pair("runs", nRun));
+            result.metrics.push_back(make_pair("points", nPoint));
+            result.metrics.push_back(make_pair("seconds", time));
+            result.metrics.push_back(make_pair("bytes", static_cast<double>(fileSize("eggp.dat"))));
+            results.push_back(result);
+        }
+    }
+}
+
+void benchLineSpec()
+{
+    const unsigned counts[] = {1000, 10000};
+    for (unsigned iCount=0; iCount<sizeof(counts)/sizeof(counts[0]); ++iCount) {
+        const unsigned nCurve = counts[iCount];
+        vector<LineSpec> specs;
+        for (unsigned i=1; i<=nCurve; ++i) {
+            LineSpec spec(i);
+            if (i%2==0) {
+                spec.set(Color, "#1a3bea");
+                spec.set(LineStyle, "--");
+            }
+            if (i%3==0) {
+                spec.set(Color, "(10,200,30)");
+                spec.set(Marker, "o");
+            }
+            specs.push_back(spec);
+        }
+
+        size_t nByte = 0;
+        double time = timeMedian(5, [&]() {
+            nByte = 0;
+            for (auto it=specs.begin(); it!=specs.end(); ++it) {
+                nByte += it->toStringWxtCairoSvg().size();
+            }
+        });
+
+        Result result;
+        result.name = "linespec";
+        result.metrics.push_back(make_pair("curves", nCurve));
+        result.metrics.push_back(make_pair("seconds", time));
+        result.metrics.push_back(make_pair("curves_per_sec", nCurve/time));
+        result.metrics.push_back(make_pair("bytes", static_cast<double>(nByte)));
+        results.push_back(result);
+    }
+}
+
+void benchExec(const string &gnuplot, bool isNative=false)
+{
+    const pair<const char*, unsigned> modes[] = {
+        make_pair("png", PNG), make_pair("eps", EPS), make_pair("pdf", PDF),
+        make_pair("html", HTML), make_pair("svg", SVG)
+    };
+    vector<DataVector> data;
+    makeData(3, 1000, data);
+
+    for (unsigned iMode=0; iMode<sizeof(modes)/sizeof(modes[0]); ++iMode) {
+        unsigned mode = modes[iMode].second;
+        if (isNative && !(mode & (PNG | SVG))) {
+            continue;
+        }
+        double time = timeMedian(5, [&]() {
+            Eggplot figure(mode);
+            if (isNative) {
+                figure.native(mode);
+            }
+            plotAll(figure, data);
+            figure.exec();
+        });
+
+        Result result;
+        result.name = "exec";
+        result.labels.push_back(make_pair("mode", modes[iMode].first));
+        result.labels.push_back(make_pair("gnuplot", gnuplot));
+        result.metrics.push_back(make_pair("curves", 3));
+        result.metrics.push_back(make_pair("points", 1000));
+        result.metrics.push_back(make_pair("seconds", time));
+        results.push_back(result);
+    }
+}
+
+void benchCache(TempDir &scratch)
+{
+    const pair<const char*, unsigned> modes[] = {make_pair("png", PNG), make_pair("svg", SVG)};
+    vector<DataVector> data;
+    makeData(3, 100000, data);
+    const string dir = scratch.path() + "/cache";
+
+    for (unsigned iMode=0; iMode<sizeof(modes)/sizeof(modes[0]); ++iMode) {
+        unsigned mode = modes[iMode].second;
+        double time[2];
+        for (int isCached=0; isCached<2; ++isCached) {
+            time[isCached] = timeMedian(5, [&]() {
+                Eggplot figure(mode);
+                figure.native(mode);
+                if (isCached) {
+                    figure.cache(dir);
+                }
+                plotAll(figure, data);
+                figure.exec();
+            });
+        }
+
+        Result result;
+        result.name = "cache";
+        result.labels.push_back(make_pair("mode", modes[iMode].first));
+        result.metrics.push_back(make_pair("curves", 3));
+        result.metrics.push_back(make_pair("points", 100000));
+        result.metrics.push_back(make_pair("seconds_render", time[0]));
+        result.metrics.push_back(make_pair("seconds_cached", time[1]));
+        results.push_back(result);
+    }
+
+    RenderCache(dir, 0).clear();
+    rmdir(dir.c_str());
+}
+
+//* the files exec(false) wrote for per-curve datablocks, rewritten as the
+//* former layout: one data set per curve, addressed by "index i"
+void writeIndexLayout(const string &dataFile, const string &script)
+{
+    ifstream dataIn("eggp.dat");
+    ofstream dataOut(dataFile.c_str());
+    string line;
+    while (getline(dataIn, line)) {
+        size_t mark = line.find(" << EOD");
+        if (mark != string::npos) {
+            dataOut << "# Curve " << line.substr(line.rfind('_', mark)+1, mark-line.rfind('_', mark)-1) << '\n';
+        }
+        else if (line == "EOD") {
+            dataOut << "\n\n";
+        }
+        else {
+            dataOut << line << '\n';
+        }
+    }
+
+    ifstream scriptIn("eggp-png.gp");
+    ofstream scriptOut(script.c_str());
+    while (getline(scriptIn, line)) {
+        if (line.compare(0, 5, "load ") == 0) {
+            continue;
+        }
+        size_t begin;
+        while ((begin = line.find('$')) != string::npos) {
+            size_t end = line.find(' ', begin);
+            size_t mark = line.rfind('_', end);
+            line.replace(begin, end-begin,
+                         "'" + dataFile + "' index " + line.substr(mark+1, end-mark-1));
+        }
+        scriptOut << line << '\n';
+    }
+}
+
+void benchManyCurves()
+{
+    const unsigned counts[] = {250, 1000, 4000};
+    const size_t   nPoint   = 100;
+    for (unsigned iCount=0; iCount<sizeof(counts)/sizeof(counts[0]); ++iCount) {
+        const unsigned nCurve = counts[iCount];
+        vector<DataVector> data;
+        makeData(nCurve, nPoint, data);
+        {
+            Eggplot figure(PNG);
+            figure.plot(vector<DataView>(data.begin(), data.end()));
+            figure.exec(false);
+        }
+        writeIndexLayout("eggp-index.dat", "eggp-index.gp");
+
+        double time[2];
+        const char *scripts[] = {"gnuplot eggp-png.gp", "gnuplot eggp-index.gp"};
+        for (int i=0; i<2; ++i) {
+            time[i] = timeMedian(3, [&]() {
+                if (system(scripts[i]) != 0) {
+                    throw runtime_error(string(scripts[i]) + " failed");
+                }
+            });
+        }
+
+        Result result;
+        result.name = "manycurves";
+        result.metrics.push_back(make_pair("curves", nCurve));
+        result.metrics.push_back(make_pair("points", nPoint));
+        result.metrics.push_back(make_pair("seconds_blocks", time[0]));
+        result.metrics.push_back(make_pair("seconds_index", time[1]));
+        results.push_back(result);
+    }
+}
+
+#ifndef _WIN32
+//* runs the exec benchmarks against a gnuplot that exits at once
+void benchExecStub(TempDir &scratch)
+{
+    string stub = scratch.file("gnuplot");
+    {
+        ofstream fout(stub.c_str());
+        fout << "#!/bin/sh\nexit 0\n";
+    }
+    chmod(stub.c_str(), 0755);
+
+    const char *env = getenv("PATH");
+    string path = env ? env : "";
+    setenv("PATH", (scratch.path() + ":" + path).c_str(), 1);
+    benchExec("stub");
+    setenv("PATH", path.c_str(), 1);
+}
+#endif
+
+}
+
+
+int main(int argc, char *argv[])
+{
+    TempDir scratch;
+    const char *names[] = {
+        "eggp.dat", "eggp.gp", "eggp-png.gp", "eggp-eps.gp", "eggp-pdf.gp",
+        "eggp-html.gp", "eggp-svg.gp", "eggp-export.png", "eggp-export.eps",
+        "eggp-export.pdf", "eggp-export.html", "eggp-export.svg", "eggp-index.dat",
+        "eggp-index.gp", "eggp-density.dat"
+    };
+    for (unsigned i=0; i<sizeof(names)/sizeof(names[0]); ++i) {
+        scratch.file(names[i]);
+    }
+
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd))==nullptr || chdir(scratch.path().c_str())!=0) {
+        cerr << "Cannot enter " << scratch.path() << endl;
+        return 1;
+    }
+
+    benchTerminal();
+    benchSerialize();
+    benchSharedX();
+    benchDensity();
+    benchEnvelope();
+    benchLineSpec();
+#ifndef _WIN32
+    benchExecStub(scratch);
+#endif
+    if (!TerminalProbe::instance().version().empty()) {
+        benchExec("real");
+    }
+    if (atoi(TerminalProbe::instance().version().c_str()) >= 5) {
+        benchManyCurves();
+    }
+    benchExec("native", true);
+    benchCache(scratch);
+
+    if (chdir(cwd)!=0) {
+        cerr << "Cannot return to " << cwd << endl;
+    }
+
+    if (argc > 1) {
+        ofstream fout(argv[1]);
+        writeJson(fout);
+        if (!fout) {
+            cerr << "Cannot write " << argv[1] << endl;
+            return 1;
+        }
+    }
+    else {
+        writeJson(cout);
+    }
+    return 0;
+}
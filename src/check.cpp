@@ -0,0 +1,390 @@
+/*
+ * Self-checks of the parts of eggplot that have to be exact, run by
+ * "make check". Every failure is printed; the exit status is the number of
+ * failed sections:
+ *
+ *   numformat   formatNumber() reads back through strtod() as the very same
+ *               double, for edge cases (subnormals, signed zeros, the ends
+ *               of the range, integers up to 2^53) and random bit patterns
+ *   pngencoder  encodePng() output, inflated with zlib, is the raster again,
+ *               for opaque and translucent images of several sizes
+ *   color       every color name gnuplot 5.4 lists in "show colornames"
+ *               resolves through parseColor() to gnuplot's value
+ *
+ * zlib is linked into the checks only; eggplot itself does not need it.
+ */
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "color.h"
+#include "numformat.h"
+#include "pngencoder.h"
+
+using namespace std;
+using namespace eggp;
+
+namespace {
+
+//* failures of the current section, printed up to maxReported
+const unsigned maxReported = 10;
+unsigned nFailure = 0;
+
+void fail(const string &what)
+{
+    if (nFailure < maxReported) {
+        fprintf(stderr, "    FAIL %s\n", what.c_str());
+    }
+    ++nFailure;
+}
+
+//* runs a section; returns 1 if any of its checks failed
+int section(const char *name, const function<void()> &run)
+{
+    nFailure = 0;
+    run();
+    printf("%-12s%s", name, nFailure ? "FAILED" : "ok");
+    if (nFailure) {
+        printf(" (%u)", nFailure);
+    }
+    printf("\n");
+    return nFailure ? 1 : 0;
+}
+
+
+//* bit-exact, so that -0.0 differs from 0.0
+bool sameDouble(double a, double b)
+{
+    uint64_t x, y;
+    memcpy(&x, &a, sizeof(x));
+    memcpy(&y, &b, sizeof(y));
+    return x == y;
+}
+
+void checkRoundTrip(double value, unsigned digits)
+{
+    char text[maxNumberLength+1];
+    const size_t n = formatNumber(text, value, digits);
+    text[n] = '\0';
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+
+    if (n == 0 || n > maxNumberLength) {
+        fail(string(buffer) + ": " + to_string(n) + " characters");
+        return;
+    }
+    char *end;
+    const double back = strtod(text, &end);
+    if (end != text+n || !sameDouble(back, value)) {
+        fail(string(buffer) + " written as \"" + text + "\" with digits " + to_string(digits));
+    }
+}
+
+void checkNumbers()
+{
+    vector<double> values = {
+        0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1.0/3, 2.0/3, 3.141592653589793,
+        1e-5, 1.5e-5, 1e-6, 1e15, 1.5e15, 1e16, 1e17, 123456789012345678.0,
+        1e308, -1e308, 1e-308, 1.7976931348623157e308, DBL_MAX, -DBL_MAX,
+        DBL_MIN, -DBL_MIN, DBL_EPSILON, 1+DBL_EPSILON, 1-DBL_EPSILON/2,
+        5e-324, -5e-324, 1e-323, 2.2250738585072009e-308, 4.9406564584124654e-324,
+        9007199254740991.0, 9007199254740992.0, -9007199254740992.0,
+        1712345678.25, 0.000125, 2.5, 0.5, 5e-1, 9.5, 99.5, 999999.5
+    };
+    for (int e=-1074; e<=1023; ++e) {
+        values.push_back(ldexp(1.0, e));
+        values.push_back(nextafter(ldexp(1.0, e), 0.0));
+        values.push_back(nextafter(ldexp(1.0, e), HUGE_VAL));
+    }
+    for (int e=-323; e<=308; ++e) {
+        const double p = strtod(("1e" + to_string(e)).c_str(), nullptr);
+        values.push_back(p);
+        values.push_back(nextafter(p, 0.0));
+        values.push_back(nextafter(p, HUGE_VAL));
+    }
+    for (int64_t i=-100000; i<=100000; ++i) {
+        values.push_back(static_cast<double>(i));
+    }
+    for (int e=0; e<=53; ++e) {
+        const int64_t p = int64_t(1) << e;
+        values.push_back(static_cast<double>(p));
+        values.push_back(static_cast<double>(p-1));
+        values.push_back(static_cast<double>(p+1));
+    }
+
+    mt19937_64 random(20240613);
+    for (size_t i=0; i<200000; ++i) {
+        //* integers up to 2^53, and any finite bit pattern
+        values.push_back(static_cast<double>(random() >> 11));
+        uint64_t bits = random();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (std::isfinite(value)) {
+            values.push_back(value);
+        }
+    }
+    uniform_real_distribution<double> uniform(-1000, 1000);
+    for (size_t i=0; i<200000; ++i) {
+        values.push_back(uniform(random));
+    }
+
+    for (double value : values) {
+        checkRoundTrip(value, 0);
+        checkRoundTrip(value, maxPrecision);
+        checkRoundTrip(-value, 0);
+    }
+
+    const struct { double value; const char *text; } special[] = {
+        {NAN, "nan"}, {HUGE_VAL, "inf"}, {-HUGE_VAL, "-inf"}, {0.0, "0"}, {-0.0, "-0"}
+    };
+    for (const auto &s : special) {
+        char text[maxNumberLength];
+        const size_t n = formatNumber(text, s.value);
+        if (string(text, n) != s.text) {
+            fail(string(s.text) + " written as \"" + string(text, n) + "\"");
+        }
+    }
+}
+
+
+
+uint32_t readBigEndian(const unsigned char *p)
+{
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+}
+
+unsigned char paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = abs(p-a), pb = abs(p-b), pc = abs(p-c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+//* false with the reason in error if png is not a valid 8-bit RGB or RGBA
+//* image; rgba gets the pixels, with alpha 255 for RGB
+bool decodePng(const string &png, unsigned &width, unsigned &height,
+               vector<unsigned char> &rgba, string &error)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(png.data());
+    const size_t size = png.size();
+    if (size < 8 || memcmp(p, "\x89PNG\r\n\x1a\n", 8) != 0) {
+        error = "no PNG signature";
+        return false;
+    }
+
+    unsigned channels = 0;
+    string idat;
+    bool ended = false;
+    for (size_t at=8; !ended; ) {
+        if (at+12 > size) {
+            error = "truncated chunk";
+            return false;
+        }
+        const uint32_t length = readBigEndian(p+at);
+        const string type(reinterpret_cast<const char *>(p+at+4), 4);
+        if (length > size-at-12) {
+            error = "chunk " + type + " runs past the end";
+            return false;
+        }
+        const unsigned char *data = p+at+8;
+        if (crc32(crc32(0, p+at+4, 4), data, length) != readBigEndian(data+length)) {
+            error = "bad CRC of chunk " + type;
+            return false;
+        }
+        if (type == "IHDR") {
+            width = readBigEndian(data);
+            height = readBigEndian(data+4);
+            if (length != 13 || data[8] != 8 || (data[9] != 2 && data[9] != 6)
+                || data[10] != 0 || data[11] != 0 || data[12] != 0) {
+                error = "IHDR is not 8-bit RGB or RGBA, non-interlaced";
+                return false;
+            }
+            channels = data[9] == 6 ? 4 : 3;
+        } else if (type == "IDAT") {
+            idat.append(reinterpret_cast<const char *>(data), length);
+        } else if (type == "IEND") {
+            ended = true;
+        }
+        at += 12 + length;
+        if (ended && at != size) {
+            error = "data after IEND";
+            return false;
+        }
+    }
+    if (channels == 0) {
+        error = "no IHDR";
+        return false;
+    }
+
+    const size_t rowLength = size_t(width)*channels;
+    vector<unsigned char> raw((rowLength+1)*height + 1);
+    uLongf rawSize = raw.size();
+    if (uncompress(raw.data(), &rawSize, reinterpret_cast<const Bytef *>(idat.data()),
+                   idat.size()) != Z_OK || rawSize != raw.size()-1) {
+        error = "IDAT does not inflate to " + to_string(raw.size()-1) + " bytes";
+        return false;
+    }
+
+    vector<unsigned char> previous(rowLength, 0), row(rowLength);
+    rgba.assign(size_t(width)*height*4, 255);
+    for (unsigned y=0; y<height; ++y) {
+        const unsigned char *line = raw.data() + y*(rowLength+1);
+        for (size_t i=0; i<rowLength; ++i) {
+            const int a = i >= channels ? row[i-channels] : 0;
+            const int b = previous[i];
+            const int c = i >= channels ? previous[i-channels] : 0;
+            int predicted;
+            switch (line[0]) {
+            case 0: predicted = 0; break;
+            case 1: predicted = a; break;
+            case 2: predicted = b; break;
+            case 3: predicted = (a+b)/2; break;
+            case 4: predicted = paeth(a, b, c); break;
+            default:
+                error = "unknown filter " + to_string(line[0]) + " in row " + to_string(y);
+                return false;
+            }
+            row[i] = static_cast<unsigned char>(line[1+i] + predicted);
+        }
+        for (unsigned x=0; x<width; ++x) {
+            memcpy(&rgba[(size_t(y)*width + x)*4], &row[x*channels], channels);
+        }
+        swap(row, previous);
+    }
+    return true;
+}
+
+//* a plot-like image: flat background, a gradient band, a few lines and
+//* noise, so that every filter and long and short matches are taken
+vector<unsigned char> makeImage(unsigned width, unsigned height, bool opaque, mt19937 &random)
+{
+    vector<unsigned char> rgba(size_t(width)*height*4, 255);
+    for (unsigned y=0; y<height; ++y) {
+        for (unsigned x=0; x<width; ++x) {
+            unsigned char *px = &rgba[(size_t(y)*width + x)*4];
+            if (y < height/4) {
+                px[0] = x; px[1] = y; px[2] = x+y;
+            } else if (y%17 == 0 || x == y) {
+                px[0] = 0; px[1] = 0x60; px[2] = 0xad;
+            } else if (x > width*3/4) {
+                px[0] = random(); px[1] = random(); px[2] = random();
+            }
+            if (!opaque) {
+                px[3] = (x*7 + y) % 3 == 0 ? random() : 0;
+            }
+        }
+    }
+    return rgba;
+}
+
+void checkPng()
+{
+    const struct { unsigned width, height; } sizes[] = {
+        {1, 1}, {2, 3}, {7, 5}, {64, 64}, {300, 1}, {1, 300}, {640, 480}, {1283, 97}
+    };
+    mt19937 random(20240613);
+    for (const auto &s : sizes) {
+        for (bool opaque : {true, false}) {
+            const vector<unsigned char> image = makeImage(s.width, s.height, opaque, random);
+            ostringstream out;
+            encodePng(out, image.data(), s.width, s.height);
+
+            const string what = to_string(s.width) + "x" + to_string(s.height)
+                                + (opaque ? " opaque" : " translucent");
+            unsigned width = 0, height = 0;
+            vector<unsigned char> decoded;
+            string error;
+            if (!decodePng(out.str(), width, height, decoded, error)) {
+                fail(what + ": " + error);
+            } else if (width != s.width || height != s.height) {
+                fail(what + ": decoded as " + to_string(width) + "x" + to_string(height));
+            } else if (decoded != image) {
+                fail(what + ": pixels differ");
+            }
+        }
+    }
+}
+
+
+
+void checkColors()
+{
+    const struct { const char *name; uint32_t rgb; } gnuplotColors[] = {
+        {"antiquewhite", 0xcdc0b0},    {"aquamarine", 0x7fffd4},      {"beige", 0xf5f5dc},
+        {"bisque", 0xcdb79e},          {"black", 0x000000},           {"blue", 0x0000ff},
+        {"brown", 0xa52a2a},           {"brown4", 0x801414},          {"chartreuse", 0x7cff40},
+        {"coral", 0xff7f50},           {"cyan", 0x00ffff},            {"dark-blue", 0x00008b},
+        {"dark-chartreuse", 0x408000}, {"dark-cyan", 0x00eeee},       {"dark-goldenrod", 0xb8860b},
+        {"dark-gray", 0xa0a0a0},       {"dark-green", 0x006400},      {"dark-grey", 0xa0a0a0},
+        {"dark-khaki", 0xbdb76b},      {"dark-magenta", 0xc000ff},    {"dark-olivegreen", 0x556b2f},
+        {"dark-orange", 0xc04000},     {"dark-pink", 0xff1493},       {"dark-plum", 0x905040},
+        {"dark-red", 0x8b0000},        {"dark-salmon", 0xe9967a},
+        {"dark-spring-green", 0x008040}, {"dark-turquoise", 0x00ced1},
+        {"dark-violet", 0x9400d3},     {"dark-yellow", 0xc8c800},     {"forest-green", 0x228b22},
+        {"gold", 0xffd700},            {"goldenrod", 0xffc020},       {"gray", 0xbebebe},
+        {"gray0", 0x000000},           {"gray10", 0x1a1a1a},          {"gray100", 0xffffff},
+        {"gray20", 0x333333},          {"gray30", 0x4d4d4d},          {"gray40", 0x666666},
+        {"gray50", 0x7f7f7f},          {"gray60", 0x999999},          {"gray70", 0xb3b3b3},
+        {"gray80", 0xcccccc},          {"gray90", 0xe5e5e5},          {"green", 0x00ff00},
+        {"greenyellow", 0xa0ff20},     {"grey", 0xc0c0c0},            {"grey0", 0x000000},
+        {"grey10", 0x1a1a1a},          {"grey100", 0xffffff},         {"grey20", 0x333333},
+        {"grey30", 0x4d4d4d},          {"grey40", 0x666666},          {"grey50", 0x7f7f7f},
+        {"grey60", 0x999999},          {"grey70", 0xb3b3b3},          {"grey80", 0xcccccc},
+        {"grey90", 0xe5e5e5},          {"honeydew", 0xf0fff0},        {"khaki", 0xf0e68c},
+        {"khaki1", 0xffff80},          {"lemonchiffon", 0xffffc0},    {"light-blue", 0xadd8e6},
+        {"light-coral", 0xf08080},     {"light-cyan", 0xe0ffff},      {"light-goldenrod", 0xeedd82},
+        {"light-gray", 0xd3d3d3},      {"light-green", 0x90ee90},     {"light-grey", 0xd3d3d3},
+        {"light-magenta", 0xf055f0},   {"light-pink", 0xffb6c1},      {"light-red", 0xf03232},
+        {"light-salmon", 0xffa070},    {"light-turquoise", 0xafeeee}, {"magenta", 0xff00ff},
+        {"medium-blue", 0x0000cd},     {"mediumpurple3", 0x8060c0},   {"midnight-blue", 0x191970},
+        {"navy", 0x000080},            {"olive", 0xa08020},           {"orange", 0xffa500},
+        {"orange-red", 0xff4500},      {"orangered4", 0x801400},      {"orchid", 0xff80ff},
+        {"orchid4", 0x804080},         {"pink", 0xffc0c0},            {"plum", 0xdda0dd},
+        {"purple", 0xc080ff},          {"red", 0xff0000},             {"royalblue", 0x4169e1},
+        {"salmon", 0xfa8072},          {"sandybrown", 0xffa060},      {"sea-green", 0x2e8b57},
+        {"seagreen", 0xc1ffc1},        {"sienna1", 0xff8040},         {"sienna4", 0x804014},
+        {"skyblue", 0x87ceeb},         {"slateblue1", 0x8060ff},      {"slategray", 0xa0b6cd},
+        {"slategrey", 0xa0b6cd},       {"spring-green", 0x00ff7f},    {"steelblue", 0x306080},
+        {"tan1", 0xffa040},            {"turquoise", 0x40e0d0},       {"violet", 0xee82ee},
+        {"web-blue", 0x0080ff},        {"web-green", 0x00c000},       {"white", 0xffffff},
+        {"yellow", 0xffff00},          {"yellow4", 0x808000},
+    };
+    for (const auto &c : gnuplotColors) {
+        uint32_t argb = 0;
+        if (!parseColor(c.name, argb)) {
+            fail(string(c.name) + " not found");
+        } else if (argb != (0xff000000u | c.rgb)) {
+            char text[maxColorTextLength];
+            fail(string(c.name) + " is " + string(text, formatColor(text, argb)));
+        }
+    }
+    for (const char *name : {"", "-", "light", "gray101", "darkgreen", "white2", "redd"}) {
+        uint32_t argb;
+        if (parseColor(name, argb)) {
+            fail(string("\"") + name + "\" accepted");
+        }
+    }
+}
+
+}
+
+
+int main()
+{
+    int nFailedSection = 0;
+    nFailedSection += section("numformat", checkNumbers);
+    nFailedSection += section("pngencoder", checkPng);
+    nFailedSection += section("color", checkColors);
+    return nFailedSection;
+}
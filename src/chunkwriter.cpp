@@ -0,0 +1,248 @@
+#include "chunkwriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "parallel.h"
+
+using namespace std;
+
+namespace eggp{
+
+namespace {
+
+//* buffers per thread, so that uneven chunks balance out and the threads
+//* can run ahead of the writer
+const size_t chunksPerThread = 4;
+
+struct Chunk
+{
+    unique_ptr<char[]> data;
+    size_t capacity;
+    size_t length;
+};
+
+//* a run of formatted chunks goes to a sink in order
+typedef function<void(const Chunk *chunks, size_t nChunk)> Sink;
+
+//* Chunk i is formatted into buffer i%nBuffer of a ring. The formatting
+//* threads take the chunks in order, each waiting for its buffer to be
+//* written; one writer thread hands every run of formatted chunks to the
+//* sink as soon as the chunk before it has been written. All threads are
+//* started once per call.
+size_t writeInOrder(const ChunkSource &source, unsigned nThread, const Sink &sink)
+{
+    if (nThread==0) {
+        nThread = defaultThreadCount();
+    }
+    const size_t nBuffer = max<size_t>(1, min(chunksPerThread*nThread, source.nChunk));
+    vector<Chunk> ring(nBuffer);
+    for (auto it=ring.begin(); it!=ring.end(); ++it) {
+        it->capacity = 0;
+        it->length   = 0;
+    }
+
+    mutex              ringMutex;
+    condition_variable isFormatted;
+    condition_variable isWritten;
+    vector<bool>       formatted(nBuffer, false);
+    size_t             nWritten = 0;
+    size_t             size = 0;
+    bool               isFailed = false;
+    exception_ptr      error;
+    atomic<size_t>     next(0);
+
+    auto fail = [&](exception_ptr e) {
+        lock_guard<mutex> lock(ringMutex);
+        if (!error) {
+            error = e;
+        }
+        isFailed = true;
+        isFormatted.notify_all();
+        isWritten.notify_all();
+    };
+
+    thread writer([&]() {
+        try {
+            while (nWritten < source.nChunk) {
+                size_t first = nWritten%nBuffer;
+                size_t n = 0;
+                {
+                    unique_lock<mutex> lock(ringMutex);
+                    isFormatted.wait(lock, [&]() { return isFailed || formatted[first]; });
+                    if (isFailed) {
+                        return;
+                    }
+                    //* every formatted chunk that follows, up to the end of the ring
+                    while (first+n < nBuffer && nWritten+n < source.nChunk && formatted[first+n]) {
+                        ++n;
+                    }
+                }
+                sink(&ring[first], n);
+
+                lock_guard<mutex> lock(ringMutex);
+                for (size_t i=0; i<n; ++i) {
+                    size += ring[first+i].length;
+                    formatted[first+i] = false;
+                }
+                nWritten += n;
+                isWritten.notify_all();
+            }
+        }
+        catch (...) {
+            fail(current_exception());
+        }
+    });
+
+    parallelFor(min<size_t>(nThread, source.nChunk), nThread, [&](size_t) {
+        try {
+            size_t iChunk;
+            while ((iChunk = next++) < source.nChunk) {
+                Chunk &chunk = ring[iChunk%nBuffer];
+                {
+                    unique_lock<mutex> lock(ringMutex);
+                    isWritten.wait(lock, [&]() { return isFailed || iChunk < nWritten+nBuffer; });
+                    if (isFailed) {
+                        return;
+                    }
+                }
+                const size_t length = source.maxLength(iChunk);
+                if (chunk.capacity < length) {
+                    chunk.data.reset(new char[length]);
+                    chunk.capacity = length;
+                }
+                chunk.length = source.format(iChunk, chunk.data.get());
+
+                lock_guard<mutex> lock(ringMutex);
+                formatted[iChunk%nBuffer] = true;
+                isFormatted.notify_one();
+            }
+        }
+        catch (...) {
+            fail(current_exception());
+        }
+    });
+    writer.join();
+
+    if (error) {
+        rethrow_exception(error);
+    }
+    return size;
+}
+
+}
+
+
+#ifdef _WIN32
+
+size_t writeChunks(const string &filename, const ChunkSource &source, unsigned nThread)
+{
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (file == nullptr) {
+        throw runtime_error("Cannot write " + filename + ": " + strerror(errno));
+    }
+    size_t size;
+    try {
+        size = writeInOrder(source, nThread, [&](const Chunk *chunks, size_t nChunk) {
+            for (size_t i=0; i<nChunk; ++i) {
+                if (fwrite(chunks[i].data.get(), 1, chunks[i].length, file) != chunks[i].length) {
+                    throw runtime_error("Cannot write " + filename);
+                }
+            }
+        });
+    }
+    catch (...) {
+        fclose(file);
+        throw;
+    }
+    if (fclose(file) != 0) {
+        throw runtime_error("Cannot write " + filename);
+    }
+    return size;
+}
+
+#else
+
+size_t writeChunks(const string &filename, const ChunkSource &source, unsigned nThread)
+{
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw runtime_error("Cannot write " + filename + ": " + strerror(errno));
+    }
+
+    size_t size;
+    try {
+        size = writeInOrder(source, nThread, [&](const Chunk *chunks, size_t nChunk) {
+            //* as many chunks per call as the system takes, resumed after
+            //* a partial write
+            vector<iovec> vectors;
+            for (size_t i=0; i<nChunk; ++i) {
+                if (chunks[i].length > 0) {
+                    iovec v;
+                    v.iov_base = chunks[i].data.get();
+                    v.iov_len  = chunks[i].length;
+                    vectors.push_back(v);
+                }
+            }
+            size_t next = 0;
+            while (next < vectors.size()) {
+                int count = static_cast<int>(min<size_t>(vectors.size()-next, IOV_MAX));
+                ssize_t n = writev(fd, &vectors[next], count);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw runtime_error("Cannot write " + filename + ": " + strerror(errno));
+                }
+                size_t written = static_cast<size_t>(n);
+                while (next < vectors.size() && written >= vectors[next].iov_len) {
+                    written -= vectors[next].iov_len;
+                    ++next;
+                }
+                if (written > 0) {
+                    vectors[next].iov_base = static_cast<char*>(vectors[next].iov_base) + written;
+                    vectors[next].iov_len -= written;
+                }
+            }
+        });
+    }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw runtime_error("Cannot write " + filename + ": " + strerror(errno));
+    }
+    return size;
+}
+
+#endif
+
+size_t writeChunks(ostream &out, const ChunkSource &source, unsigned nThread)
+{
+    return writeInOrder(source, nThread, [&](const Chunk *chunks, size_t nChunk) {
+        for (size_t i=0; i<nChunk; ++i) {
+            out.write(chunks[i].data.get(), chunks[i].length);
+        }
+    });
+}
+
+
+}
@@ -0,0 +1,337 @@
+#include "color.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+struct NamedColor {
+    const char *name;
+    uint32_t    rgb;
+};
+
+//* bucket seeds of the perfect hash, indexed by hashName(name, 0) % 64; each
+//* is the first seed placing its bucket's names in free slots, largest
+//* buckets first, so adding a name means searching them again
+const uint16_t colorSeeds[64] = {
+        0,     3,     0,     2,     2,     4,     2,     0,
+        6,     1,     2,     4,     1,     0,     2,     1,
+        2,     0,     2,     2,     4,     1,     5,     6,
+       11,     1,     9,     9,     1,     3,     0,     1,
+        4,     0,     1,     4,     4,     2,     6,     2,
+       10,     3,     3,     2,    26,     0,     2,     6,
+        4,     3,     5,     0,     9,     5,    11,     9,
+        1,    13,    10,     0,     0,     3,    30,     6
+};
+
+//* gnuplot's color names at slot hashName(name, seed) % 128, "" for free slots
+const NamedColor namedColors[128] = {
+    {"dark-goldenrod",      0xb8860b},
+    {"gray10",              0x1a1a1a},
+    {"light-green",         0x90ee90},
+    {"orchid",              0xff80ff},
+    {"light-pink",          0xffb6c1},
+    {"",                    0x000000},
+    {"gray20",              0x333333},
+    {"",                    0x000000},
+    {"light-coral",         0xf08080},
+    {"gray90",              0xe5e5e5},
+    {"khaki1",              0xffff80},
+    {"grey60",              0x999999},
+    {"dark-magenta",        0xc000ff},
+    {"turquoise",           0x40e0d0},
+    {"dark-green",          0x006400},
+    {"orangered4",          0x801400},
+    {"coral",               0xff7f50},
+    {"goldenrod",           0xffc020},
+    {"",                    0x000000},
+    {"web-blue",            0x0080ff},
+    {"gray",                0xbebebe},
+    {"dark-salmon",         0xe9967a},
+    {"dark-chartreuse",     0x408000},
+    {"midnight-blue",       0x191970},
+    {"",                    0x000000},
+    {"sienna4",             0x804014},
+    {"mediumpurple3",       0x8060c0},
+    {"web-green",           0x00c000},
+    {"navy",                0x000080},
+    {"salmon",              0xfa8072},
+    {"grey90",              0xe5e5e5},
+    {"purple",              0xc080ff},
+    {"",                    0x000000},
+    {"grey10",              0x1a1a1a},
+    {"sandybrown",          0xffa060},
+    {"gold",                0xffd700},
+    {"light-magenta",       0xf055f0},
+    {"violet",              0xee82ee},
+    {"",                    0x000000},
+    {"cyan",                0x00ffff},
+    {"gray80",              0xcccccc},
+    {"blue",                0x0000ff},
+    {"greenyellow",         0xa0ff20},
+    {"khaki",               0xf0e68c},
+    {"chartreuse",          0x7cff40},
+    {"grey40",              0x666666},
+    {"gray70",              0xb3b3b3},
+    {"",                    0x000000},
+    {"dark-turquoise",      0x00ced1},
+    {"spring-green",        0x00ff7f},
+    {"light-gray",          0xd3d3d3},
+    {"dark-orange",         0xc04000},
+    {"slategrey",           0xa0b6cd},
+    {"dark-yellow",         0xc8c800},
+    {"medium-blue",         0x0000cd},
+    {"",                    0x000000},
+    {"grey0",               0x000000},
+    {"dark-plum",           0x905040},
+    {"black",               0x000000},
+    {"olive",               0xa08020},
+    {"light-red",           0xf03232},
+    {"grey80",              0xcccccc},
+    {"dark-gray",           0xa0a0a0},
+    {"",                    0x000000},
+    {"dark-red",            0x8b0000},
+    {"",                    0x000000},
+    {"antiquewhite",        0xcdc0b0},
+    {"lemonchiffon",        0xffffc0},
+    {"gray40",              0x666666},
+    {"aquamarine",          0x7fffd4},
+    {"bisque",              0xcdb79e},
+    {"",                    0x000000},
+    {"grey70",              0xb3b3b3},
+    {"red",                 0xff0000},
+    {"gray30",              0x4d4d4d},
+    {"orange",              0xffa500},
+    {"light-cyan",          0xe0ffff},
+    {"white",               0xffffff},
+    {"grey100",             0xffffff},
+    {"magenta",             0xff00ff},
+    {"grey30",              0x4d4d4d},
+    {"gray50",              0x7f7f7f},
+    {"yellow4",             0x808000},
+    {"dark-pink",           0xff1493},
+    {"",                    0x000000},
+    {"orange-red",          0xff4500},
+    {"sea-green",           0x2e8b57},
+    {"plum",                0xdda0dd},
+    {"",                    0x000000},
+    {"grey20",              0x333333},
+    {"",                    0x000000},
+    {"green",               0x00ff00},
+    {"dark-olivegreen",     0x556b2f},
+    {"pink",                0xffc0c0},
+    {"light-goldenrod",     0xeedd82},
+    {"steelblue",           0x306080},
+    {"beige",               0xf5f5dc},
+    {"gray0",               0x000000},
+    {"dark-khaki",          0xbdb76b},
+    {"slateblue1",          0x8060ff},
+    {"dark-grey",           0xa0a0a0},
+    {"honeydew",            0xf0fff0},
+    {"light-blue",          0xadd8e6},
+    {"",                    0x000000},
+    {"dark-spring-green",   0x008040},
+    {"yellow",              0xffff00},
+    {"brown",               0xa52a2a},
+    {"light-salmon",        0xffa070},
+    {"dark-blue",           0x00008b},
+    {"sienna1",             0xff8040},
+    {"skyblue",             0x87ceeb},
+    {"",                    0x000000},
+    {"grey50",              0x7f7f7f},
+    {"tan1",                0xffa040},
+    {"grey",                0xc0c0c0},
+    {"dark-violet",         0x9400d3},
+    {"light-grey",          0xd3d3d3},
+    {"light-turquoise",     0xafeeee},
+    {"orchid4",             0x804080},
+    {"forest-green",        0x228b22},
+    {"dark-cyan",           0x00eeee},
+    {"gray100",             0xffffff},
+    {"brown4",              0x801414},
+    {"seagreen",            0xc1ffc1},
+    {"royalblue",           0x4169e1},
+    {"slategray",           0xa0b6cd},
+    {"gray60",              0x999999},
+    {"",                    0x000000}
+};
+
+
+struct ColorShortCut {
+    char     shortCut;
+    uint32_t rgb;
+};
+
+const ColorShortCut colorShortCuts[] = {
+    {'y', 0xffff00}, {'m', 0xff00ff}, {'c', 0x00ffff}, {'r', 0xff0000},
+    {'g', 0x00ff00}, {'b', 0x0000ff}, {'w', 0xffffff}, {'k', 0x000000}
+};
+
+//* FNV-1a with a seed, then mixed so that the low bits depend on every byte
+uint32_t hashName(const char *name, size_t n, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i=0; i<n; ++i) {
+        h ^= static_cast<unsigned char>(name[i]);
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+bool findName(const char *name, size_t n, uint32_t &rgb)
+{
+    uint32_t seed = colorSeeds[hashName(name, n, 0) % 64];
+    const NamedColor &entry = namedColors[hashName(name, n, seed) % 128];
+    if (strlen(entry.name)!=n || memcmp(entry.name, name, n)!=0) {
+        return false;
+    }
+    rgb = entry.rgb;
+    return true;
+}
+
+bool parseHex(const char *digits, size_t n, uint32_t &value)
+{
+    value = 0;
+    for (size_t i=0; i<n; ++i) {
+        char c = digits[i];
+        uint32_t nibble;
+        if (c>='0' && c<='9') {
+            nibble = c-'0';
+        }
+        else if (c>='a' && c<='f') {
+            nibble = c-'a'+10;
+        }
+        else if (c>='A' && c<='F') {
+            nibble = c-'A'+10;
+        }
+        else {
+            return false;
+        }
+        value = (value<<4) | nibble;
+    }
+    return true;
+}
+
+//* "(r,g,b)" or "[r,g,b]" without whitespace, brackets included
+bool parseTriple(const char *text, size_t n, uint32_t &rgb)
+{
+    const bool isDecimal = text[0]=='(';
+    if (n < 7 || text[n-1] != (isDecimal ? ')' : ']')) {
+        return false;
+    }
+
+    rgb = 0;
+    const char *p = text+1;
+    for (int i=0; i<3; ++i) {
+        char *end;
+        long channel;
+        if (isDecimal) {
+            channel = strtol(p, &end, 10);
+            if (channel<0 || channel>255) {
+                return false;
+            }
+        }
+        else {
+            double value = strtod(p, &end);
+            if (!(value>=0 && value<=1)) {
+                return false;
+            }
+            //* 256 steps of width 1/256, with 1.0 in the last
+            channel = min(255L, static_cast<long>(value*256));
+        }
+        if (end==p || *end != ((i<2) ? ',' : text[n-1]) || end-text >= static_cast<long>(n)) {
+            return false;
+        }
+        rgb = (rgb<<8) | static_cast<uint32_t>(channel);
+        p = end+1;
+    }
+    return p == text+n;
+}
+
+}
+
+
+bool parseColor(const string &color, uint32_t &argb)
+{
+    //* without whitespace, in a fixed buffer: longer specs are no colors
+    char text[64];
+    size_t n = 0;
+    for (auto it=color.begin(); it!=color.end(); ++it) {
+        if (*it==' ' || *it=='\t' || *it=='\n' || *it=='\r') {
+            continue;
+        }
+        if (n+1 >= sizeof(text)) {
+            return false;
+        }
+        text[n++] = *it;
+    }
+    text[n] = '\0';
+    if (n == 0) {
+        return false;
+    }
+
+    uint32_t value;
+    if (n==1) {
+        for (unsigned i=0; i<sizeof(colorShortCuts)/sizeof(colorShortCuts[0]); ++i) {
+            if (colorShortCuts[i].shortCut == text[0]) {
+                argb = 0xff000000u | colorShortCuts[i].rgb;
+                return true;
+            }
+        }
+        return false;
+    }
+    if (n==7 && text[0]=='#' && parseHex(text+1, 6, value)) {
+        argb = 0xff000000u | value;
+        return true;
+    }
+    if (n==8 && text[0]=='0' && (text[1]=='x' || text[1]=='X') && parseHex(text+2, 6, value)) {
+        argb = 0xff000000u | value;
+        return true;
+    }
+    if (n==9 && text[0]=='#' && parseHex(text+1, 8, value)) {
+        //* gnuplot's leading byte is transparency, ours is opacity
+        argb = (value & 0x00ffffffu) | ((0xffu - (value>>24)) << 24);
+        return true;
+    }
+    if (text[0]=='(' || text[0]=='[') {
+        if (!parseTriple(text, n, value)) {
+            return false;
+        }
+        argb = 0xff000000u | value;
+        return true;
+    }
+    if (findName(text, n, value)) {
+        argb = 0xff000000u | value;
+        return true;
+    }
+    return false;
+}
+
+size_t formatColor(char *out, uint32_t argb)
+{
+    const char digits[] = "0123456789abcdef";
+    const uint32_t opacity = argb >> 24;
+    size_t n = 0;
+    out[n++] = '#';
+    if (opacity != 0xff) {
+        const uint32_t transparency = 0xff - opacity;
+        out[n++] = digits[transparency >> 4];
+        out[n++] = digits[transparency & 0xf];
+    }
+    for (int shift=20; shift>=0; shift-=4) {
+        out[n++] = digits[(argb >> shift) & 0xf];
+    }
+    return n;
+}
+
+
+}
@@ -0,0 +1,308 @@
+#include "datafile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "chunkwriter.h"
+#include "mappedfile.h"
+#include "parallel.h"
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+const size_t recordSize = 2*sizeof(double);
+
+const size_t maxPointLength  = 2*maxNumberLength + 2;
+const size_t maxHeaderLength = 32;
+const size_t trailerLength   = 2;
+const size_t blockTrailerLength = 4;
+
+//* points or records of a curve handled by one task; long curves are
+//* split, so that a single curve keeps every thread busy too
+const size_t pointsPerChunk  = 1 << 14;
+const size_t recordsPerChunk = 1 << 16;
+
+//* rows converted by one task of the columnar binary writer
+const size_t rowsPerBlock = 4096;
+
+//* numbers formatted by one task of the columnar text writers
+const size_t numbersPerChunk = 1 << 15;
+
+size_t blockCount(size_t nRow)
+{
+    return (nRow + rowsPerBlock - 1)/rowsPerBlock;
+}
+
+//* points [begin, end) of a curve
+struct CurveChunk
+{
+    size_t iCurve;
+    size_t begin;
+    size_t end;
+};
+
+//* every curve in pieces of at most nPoint points, an empty curve as one
+//* empty piece
+vector<CurveChunk> splitCurves(const vector<pair<DataView, DataView>> &curves, size_t nPoint)
+{
+    vector<CurveChunk> chunks;
+    for (size_t i=0; i<curves.size(); ++i) {
+        const size_t n = curves[i].first.size();
+        size_t begin = 0;
+        do {
+            const size_t end = min(n, begin+nPoint);
+            chunks.push_back(CurveChunk{i, begin, end});
+            begin = end;
+        } while (begin < n);
+    }
+    return chunks;
+}
+
+//* "x,y" lines per curve, framed as a data set or as a datablock
+template <typename Target>
+size_t writeCurvesText(Target &target,
+                       const vector<pair<DataView, DataView>> &curves,
+                       unsigned nThread,
+                       const vector<unsigned> &digits,
+                       const string &blockName)
+{
+    const vector<CurveChunk> chunks = splitCurves(curves, pointsPerChunk);
+
+    ChunkSource source;
+    source.nChunk    = chunks.size();
+    source.maxLength = [&](size_t i) {
+        return maxHeaderLength + blockName.size() + blockTrailerLength
+               + (chunks[i].end - chunks[i].begin)*maxPointLength;
+    };
+    source.format = [&](size_t i, char *out) {
+        const CurveChunk &chunk = chunks[i];
+        const DataView &x = curves[chunk.iCurve].first;
+        const DataView &y = curves[chunk.iCurve].second;
+        const unsigned nDigit = (chunk.iCurve < digits.size()) ? digits[chunk.iCurve] : 0;
+        char *p = out;
+        if (chunk.begin == 0) {
+            const string index  = to_string(static_cast<unsigned long long>(chunk.iCurve));
+            const string header = blockName.empty() ? "# Curve " + index + "\n"
+                                                    : blockName + "_" + index + " << EOD\n";
+            memcpy(p, header.data(), header.size());
+            p += header.size();
+        }
+        for (size_t k=chunk.begin; k<chunk.end; ++k) {
+            p += formatNumber(p, x[k], nDigit);
+            *p++ = ',';
+            p += formatNumber(p, y[k], nDigit);
+            *p++ = '\n';
+        }
+        if (chunk.end == x.size()) {
+            if (blockName.empty()) {
+                *p++ = '\n';
+                *p++ = '\n';
+            }
+            else {
+                memcpy(p, "EOD\n", blockTrailerLength);
+                p += blockTrailerLength;
+            }
+        }
+        return static_cast<size_t>(p - out);
+    };
+    return writeChunks(target, source, nThread);
+}
+
+//* rows "x,y1,...,yN" of curves sharing x, in blocks of rows
+template <typename Target>
+size_t writeColumnsText(Target &target,
+                        const vector<pair<DataView, DataView>> &curves,
+                        unsigned nThread,
+                        const vector<unsigned> &digits)
+{
+    const DataView &x = curves.front().first;
+    const size_t nColumn = curves.size()+1;
+    const size_t nRow    = max<size_t>(1, numbersPerChunk/nColumn);
+
+    vector<unsigned> nDigit(curves.size(), 0);
+    for (size_t j=0; j<curves.size(); ++j) {
+        nDigit[j] = (j < digits.size()) ? digits[j] : 0;
+    }
+    const unsigned nDigitX = sharedDigits(nDigit);
+
+    const string header = "# Columns: x and curves 0-" + to_string(static_cast<unsigned long long>(curves.size()-1)) + "\n";
+    const size_t rowLength = nColumn*(maxNumberLength+1);
+
+    ChunkSource source;
+    source.nChunk    = max<size_t>(1, (x.size() + nRow - 1)/nRow);
+    source.maxLength = [&](size_t i) {
+        return header.size() + trailerLength + min(nRow, x.size() - min(x.size(), i*nRow))*rowLength;
+    };
+    source.format = [&](size_t i, char *out) {
+        const size_t begin = min(x.size(), i*nRow);
+        const size_t end   = min(x.size(), begin+nRow);
+        char *p = out;
+        if (i == 0) {
+            memcpy(p, header.data(), header.size());
+            p += header.size();
+        }
+        for (size_t k=begin; k<end; ++k) {
+            p += formatNumber(p, x[k], nDigitX);
+            for (size_t j=0; j<curves.size(); ++j) {
+                *p++ = ',';
+                p += formatNumber(p, curves[j].second[k], nDigit[j]);
+            }
+            *p++ = '\n';
+        }
+        if (i+1 == source.nChunk) {
+            *p++ = '\n';
+            *p++ = '\n';
+        }
+        return static_cast<size_t>(p - out);
+    };
+    return writeChunks(target, source, nThread);
+}
+
+//* interleaved float64 (x,y) records of one piece of a curve; an empty
+//* curve is a single NaN record
+size_t convertRecords(const pair<DataView, DataView> &curve, const CurveChunk &chunk, char *out)
+{
+    const DataView &x = curve.first;
+    const DataView &y = curve.second;
+    if (x.empty()) {
+        const double nan[2] = {NAN, NAN};
+        memcpy(out, nan, recordSize);
+        return recordSize;
+    }
+    for (size_t k=chunk.begin; k<chunk.end; ++k) {
+        const double record[2] = {x[k], y[k]};
+        memcpy(out + (k-chunk.begin)*recordSize, record, recordSize);
+    }
+    return (chunk.end - chunk.begin)*recordSize;
+}
+
+}
+
+
+unsigned sharedDigits(const vector<unsigned> &digits)
+{
+    unsigned nDigit = 0;
+    for (auto it=digits.begin(); it!=digits.end(); ++it) {
+        if (*it == 0) {
+            return 0;
+        }
+        nDigit = max(nDigit, *it);
+    }
+    return nDigit;
+}
+
+size_t writeDataFileBinary(const string &filename,
+                           const vector<pair<DataView, DataView>> &curves,
+                           unsigned nThread)
+{
+    const vector<CurveChunk> chunks = splitCurves(curves, recordsPerChunk);
+    vector<size_t> offset(chunks.size()+1, 0);
+    for (size_t i=0; i<chunks.size(); ++i) {
+        size_t nRecord = max<size_t>(chunks[i].end - chunks[i].begin, 1);
+        offset[i+1] = offset[i] + nRecord*recordSize;
+    }
+
+    //* sizes are exact, so every piece is converted straight into place
+    MappedFile file(filename, offset.back());
+    char *data = file.data();
+    parallelFor(chunks.size(), nThread, [&](size_t i) {
+        convertRecords(curves[chunks[i].iCurve], chunks[i], data + offset[i]);
+    });
+    file.close(offset.back());
+    return offset.back();
+}
+
+size_t writeDataFileText(const string &filename,
+                         const vector<pair<DataView, DataView>> &curves,
+                         unsigned nThread,
+                         const vector<unsigned> &digits,
+                         const string &blockName)
+{
+    return writeCurvesText(filename, curves, nThread, digits, blockName);
+}
+
+size_t writeDataStreamText(ostream &out,
+                           const vector<pair<DataView, DataView>> &curves,
+                           unsigned nThread,
+                           const vector<unsigned> &digits,
+                           const string &blockName)
+{
+    return writeCurvesText(out, curves, nThread, digits, blockName);
+}
+
+size_t writeDataStreamBinary(ostream &out,
+                             const vector<pair<DataView, DataView>> &curves,
+                             unsigned nThread)
+{
+    const vector<CurveChunk> chunks = splitCurves(curves, recordsPerChunk);
+
+    ChunkSource source;
+    source.nChunk    = chunks.size();
+    source.maxLength = [&](size_t i) {
+        return max<size_t>(chunks[i].end - chunks[i].begin, 1)*recordSize;
+    };
+    source.format = [&](size_t i, char *out) {
+        return convertRecords(curves[chunks[i].iCurve], chunks[i], out);
+    };
+    return writeChunks(out, source, nThread);
+}
+
+size_t writeDataFileColumnsBinary(const string &filename,
+                                  const vector<pair<DataView, DataView>> &curves,
+                                  unsigned nThread)
+{
+    const DataView &x = curves.front().first;
+    const size_t nColumn = curves.size()+1;
+    const size_t rowSize = nColumn*sizeof(double);
+    const size_t size    = max<size_t>(x.size(), 1)*rowSize;
+
+    MappedFile file(filename, size);
+    char *data = file.data();
+    if (x.empty()) {
+        const double nan = NAN;
+        for (size_t j=0; j<nColumn; ++j) {
+            memcpy(data + j*sizeof(double), &nan, sizeof(double));
+        }
+    }
+    parallelFor(blockCount(x.size()), nThread, [&](size_t iBlock) {
+        //* gathered column by column, so every source is read sequentially
+        const size_t begin = iBlock*rowsPerBlock;
+        const size_t end   = min(x.size(), begin+rowsPerBlock);
+        vector<double> rows((end-begin)*nColumn);
+        for (size_t k=begin; k<end; ++k) {
+            rows[(k-begin)*nColumn] = x[k];
+        }
+        for (size_t j=0; j<curves.size(); ++j) {
+            const DataView &y = curves[j].second;
+            for (size_t k=begin; k<end; ++k) {
+                rows[(k-begin)*nColumn + j+1] = y[k];
+            }
+        }
+        memcpy(data + begin*rowSize, rows.data(), rows.size()*sizeof(double));
+    });
+    file.close(size);
+    return size;
+}
+
+size_t writeDataFileColumnsText(const string &filename,
+                                const vector<pair<DataView, DataView>> &curves,
+                                unsigned nThread,
+                                const vector<unsigned> &digits)
+{
+    return writeColumnsText(filename, curves, nThread, digits);
+}
+
+size_t writeDataStreamColumnsText(ostream &out,
+                                  const vector<pair<DataView, DataView>> &curves,
+                                  unsigned nThread,
+                                  const vector<unsigned> &digits)
+{
+    return writeColumnsText(out, curves, nThread, digits);
+}
+
+}
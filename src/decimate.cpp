@@ -0,0 +1,136 @@
+#include "decimate.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+void copyAll(const DataView &x, const DataView &y, DataVector &xOut, DataVector &yOut)
+{
+    xOut.resize(x.size());
+    yOut.resize(y.size());
+    for (size_t i=0; i<x.size(); ++i) {
+        xOut[i] = x[i];
+        yOut[i] = y[i];
+    }
+}
+
+}
+
+
+void decimateLttb(const DataView &x, const DataView &y, size_t nOut,
+                  DataVector &xOut, DataVector &yOut)
+{
+    const size_t n = x.size();
+    if (nOut >= n || nOut < 3) {
+        copyAll(x, y, xOut, yOut);
+        return;
+    }
+
+    xOut.clear();
+    yOut.clear();
+    xOut.reserve(nOut);
+    yOut.reserve(nOut);
+
+    //* first and last points are always kept; the rest is split into
+    //* nOut-2 buckets of about the same number of points
+    const double every = static_cast<double>(n-2)/(nOut-2);
+
+    size_t a = 0;
+    xOut.push_back(x[0]);
+    yOut.push_back(y[0]);
+
+    for (size_t i=0; i<nOut-2; ++i) {
+        //* average of the next bucket is the third vertex of the triangle
+        size_t avgBegin = static_cast<size_t>(floor((i+1)*every))+1;
+        size_t avgEnd   = static_cast<size_t>(floor((i+2)*every))+1;
+        avgEnd = (avgEnd < n) ? avgEnd : n;
+
+        double avgX = 0;
+        double avgY = 0;
+        for (size_t j=avgBegin; j<avgEnd; ++j) {
+            avgX += x[j];
+            avgY += y[j];
+        }
+        size_t nAvg = avgEnd-avgBegin;
+        if (nAvg > 0) {
+            avgX /= nAvg;
+            avgY /= nAvg;
+        }
+        else {
+            avgX = x[n-1];
+            avgY = y[n-1];
+        }
+
+        //* pick the point of this bucket spanning the largest triangle
+        size_t begin = static_cast<size_t>(floor(i*every))+1;
+        size_t end   = static_cast<size_t>(floor((i+1)*every))+1;
+        const double ax = x[a];
+        const double ay = y[a];
+
+        double maxArea = -1;
+        size_t next    = begin;
+        for (size_t j=begin; j<end; ++j) {
+            double area = fabs((ax-avgX)*(y[j]-ay) - (ax-x[j])*(avgY-ay));
+            if (area > maxArea) {
+                maxArea = area;
+                next    = j;
+            }
+        }
+
+        xOut.push_back(x[next]);
+        yOut.push_back(y[next]);
+        a = next;
+    }
+
+    xOut.push_back(x[n-1]);
+    yOut.push_back(y[n-1]);
+}
+
+void decimateMinMax(const DataView &x, const DataView &y, size_t nBucket,
+                    DataVector &xOut, DataVector &yOut)
+{
+    const size_t n = x.size();
+    if (2*nBucket >= n || nBucket == 0) {
+        copyAll(x, y, xOut, yOut);
+        return;
+    }
+
+    xOut.clear();
+    yOut.clear();
+    xOut.reserve(2*nBucket);
+    yOut.reserve(2*nBucket);
+
+    for (size_t b=0; b<nBucket; ++b) {
+        size_t begin = b*n/nBucket;
+        size_t end   = (b+1)*n/nBucket;
+
+        size_t iMin = begin;
+        size_t iMax = begin;
+        for (size_t j=begin+1; j<end; ++j) {
+            if (y[j] < y[iMin]) {
+                iMin = j;
+            }
+            if (y[j] > y[iMax]) {
+                iMax = j;
+            }
+        }
+
+        //* keep the original order so the line still runs left to right
+        size_t first  = (iMin < iMax) ? iMin : iMax;
+        size_t second = (iMin < iMax) ? iMax : iMin;
+        xOut.push_back(x[first]);
+        yOut.push_back(y[first]);
+        if (second != first) {
+            xOut.push_back(x[second]);
+            yOut.push_back(y[second]);
+        }
+    }
+}
+
+
+}
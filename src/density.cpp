@@ -0,0 +1,151 @@
+#include "density.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "mappedfile.h"
+#include "parallel.h"
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+//* fewer points than this per thread are not worth another histogram
+const size_t minPointsPerThread = 1 << 16;
+
+struct Bounds
+{
+    double xMin;
+    double xMax;
+    double yMin;
+    double yMax;
+};
+
+//* calls visit(x, y) for the points [begin, end) of all curves in order;
+//* first[i] is the index of the first point of curve i
+template <typename Visit>
+void forEachPoint(const vector<pair<DataView, DataView>> &curves, const vector<size_t> &first,
+                  size_t begin, size_t end, Visit visit)
+{
+    size_t iCurve = upper_bound(first.begin(), first.end(), begin) - first.begin() - 1;
+    for (size_t i=begin; i<end; ++iCurve) {
+        const DataView &x = curves[iCurve].first;
+        const DataView &y = curves[iCurve].second;
+        const size_t last = min(end, first[iCurve+1]);
+        for (; i<last; ++i) {
+            visit(x[i-first[iCurve]], y[i-first[iCurve]]);
+        }
+    }
+}
+
+}
+
+
+void binDensity(const vector<pair<DataView, DataView>> &curves,
+                unsigned nx, unsigned ny, unsigned nThread, DensityGrid &grid)
+{
+    vector<size_t> first(curves.size()+1, 0);
+    for (size_t i=0; i<curves.size(); ++i) {
+        first[i+1] = first[i] + curves[i].first.size();
+    }
+    const size_t nPoint = first.back();
+
+    if (nThread==0) {
+        nThread = defaultThreadCount();
+    }
+    const size_t nSlot = max<size_t>(1, min<size_t>(nThread, nPoint/minPointsPerThread));
+    auto slotBegin = [&](size_t iSlot) { return nPoint*iSlot/nSlot; };
+
+    //* bounding box of the finite points, one per slot, then combined
+    const double inf = numeric_limits<double>::infinity();
+    vector<Bounds> slotBounds(nSlot, Bounds{inf, -inf, inf, -inf});
+    parallelFor(nSlot, nThread, [&](size_t iSlot) {
+        Bounds &b = slotBounds[iSlot];
+        forEachPoint(curves, first, slotBegin(iSlot), slotBegin(iSlot+1), [&](double x, double y) {
+            if (std::isfinite(x) && std::isfinite(y)) {
+                b.xMin = min(b.xMin, x);
+                b.xMax = max(b.xMax, x);
+                b.yMin = min(b.yMin, y);
+                b.yMax = max(b.yMax, y);
+            }
+        });
+    });
+    Bounds bounds = slotBounds.front();
+    for (auto it=slotBounds.begin()+1; it!=slotBounds.end(); ++it) {
+        bounds.xMin = min(bounds.xMin, it->xMin);
+        bounds.xMax = max(bounds.xMax, it->xMax);
+        bounds.yMin = min(bounds.yMin, it->yMin);
+        bounds.yMax = max(bounds.yMax, it->yMax);
+    }
+    if (bounds.xMin > bounds.xMax) {
+        bounds = Bounds{0, 1, 0, 1};
+    }
+    //* a single column or row of points still gets cells of some size
+    if (bounds.xMin == bounds.xMax) {
+        bounds.xMin -= 0.5;
+        bounds.xMax += 0.5;
+    }
+    if (bounds.yMin == bounds.yMax) {
+        bounds.yMin -= 0.5;
+        bounds.yMax += 0.5;
+    }
+
+    grid.nx   = nx;
+    grid.ny   = ny;
+    grid.xMin = bounds.xMin;
+    grid.xMax = bounds.xMax;
+    grid.yMin = bounds.yMin;
+    grid.yMax = bounds.yMax;
+
+    //* one histogram per slot; the maximum falls into the last cell
+    const size_t nCell = static_cast<size_t>(nx)*ny;
+    const double scaleX = nx/(bounds.xMax - bounds.xMin);
+    const double scaleY = ny/(bounds.yMax - bounds.yMin);
+    vector<vector<uint32_t>> histograms(nSlot);
+    parallelFor(nSlot, nThread, [&](size_t iSlot) {
+        vector<uint32_t> &counts = histograms[iSlot];
+        counts.assign(nCell, 0);
+        forEachPoint(curves, first, slotBegin(iSlot), slotBegin(iSlot+1), [&](double x, double y) {
+            if (std::isfinite(x) && std::isfinite(y)) {
+                size_t ix = min<size_t>(nx-1, static_cast<size_t>((x - bounds.xMin)*scaleX));
+                size_t iy = min<size_t>(ny-1, static_cast<size_t>((y - bounds.yMin)*scaleY));
+                ++counts[iy*nx + ix];
+            }
+        });
+    });
+
+    //* merged by rows, in parallel as well
+    grid.cells.assign(nCell, 0);
+    parallelFor(ny, nThread, [&](size_t iy) {
+        double *row = grid.cells.data() + iy*nx;
+        for (size_t iSlot=0; iSlot<nSlot; ++iSlot) {
+            const uint32_t *counts = histograms[iSlot].data() + iy*nx;
+            for (size_t ix=0; ix<nx; ++ix) {
+                row[ix] += counts[ix];
+            }
+        }
+        for (size_t ix=0; ix<nx; ++ix) {
+            if (row[ix] == 0) {
+                row[ix] = NAN;
+            }
+        }
+    });
+}
+
+size_t writeDensityFile(const string &filename, const DensityGrid &grid)
+{
+    const size_t size = grid.cells.size()*sizeof(double);
+    MappedFile file(filename, size);
+    memcpy(file.data(), grid.cells.data(), size);
+    file.close(size);
+    return size;
+}
+
+
+}
@@ -1,6 +1,17 @@
 #include "eggplot.h"
+#include "datafile.h"
+#include "decimate.h"
+#include "density.h"
+#include "envelope.h"
+#include "numformat.h"
+#include "parallel.h"
+#include "pngwriter.h"
+#include "renderpool.h"
+#include "svgwriter.h"
+#include "terminal.h"
 
 #include<algorithm>
+#include<atomic>
 #include<fstream>
 #include<stdexcept>
 #include<cstdlib>
@@ -12,6 +23,44 @@ using namespace std;
 
 namespace eggp {
 
+namespace {
+
+//* the very same doubles, not merely equal values
+bool isSameView(const DataView &a, const DataView &b)
+{
+    return a.data()==b.data() && a.size()==b.size() && a.stride()==b.stride();
+}
+
+//* shortest text that reads back as the same double
+string exactNumber(double value)
+{
+    char buffer[maxNumberLength];
+    return string(buffer, formatNumber(buffer, value));
+}
+
+//* legend of the band between the quantiles q and 1-q, e.g. "5-95%"
+string percentRange(double q)
+{
+    ostringstream out;
+    out << 100*q << "-" << 100*(1-q) << "%";
+    return out.str();
+}
+
+//* output modes that produce a file, which the render cache can keep
+struct FileMode
+{
+    unsigned    mode;
+    const char *name;
+    const char *extension;
+};
+
+const FileMode fileModes[] = {
+    {PNG, "PNG", ".png"}, {EPS, "EPS", ".eps"}, {PDF, "PDF", ".pdf"},
+    {HTML, "HTML", ".html"}, {SVG, "SVG", ".svg"}
+};
+
+}
+
 
 Eggplot::Eggplot(unsigned mode)
     : filenamePrefix("eggp"),
@@ -19,21 +68,67 @@ Eggplot::Eggplot(unsigned mode)
       labelY(),
       labelTitle(),
       legendVec(0),
+      curveLegend(),
       lineSpecInput(),
       lineSpec(),
       lineSpecAqua(),
       lineSpecCanvas(),
       lineSpecOther(),
+      curveData(),
+      ownedData(),
+      renderCurves(),
+      decimatedData(),
+      decimation(NO_DECIMATION),
+      nDecimatePoint(0),
+      densityX(0),
+      densityY(0),
+      isDensityLog(false),
+      densityGrid(),
+      isBinnedCurve(),
+      nBandCurve(0),
+      envelopeLegend(),
+      streamX(),
+      streamY(),
+      streamCapacity(0),
+      streamInterval(0),
+      lastRefresh(),
       nCurve(0),
       isGridded(false),
-      filenameExport("eggp-export")
+      isBinary(false),
+      defaultPrecision(0),
+      curvePrecision(),
+      filenameExport("eggp-export"),
+      workDir(),
+      workDirParent(),
+      gnuplotSession(),
+      isInline(false),
+      hasDatablocks(false),
+      datablockName(),
+      inlineData(),
+      renderJobs(),
+      nThread(0),
+      nativeMode(0),
+      recorder(),
+      probeSeconds(0),
+      traceFilename(),
+      renderCache()
 {
-    //* Test if terminal exists
-    this->existsAqua   = this->existsTerminal("aqua");
-    this->existsWxt    = this->existsTerminal("wxt");
-    this->existsCairo  = this->existsTerminal("cairo");
-    this->existsCanvas = this->existsTerminal("canvas");
-    this->existsSvg    = this->existsTerminal("svg");
+    //* datablocks live in gnuplot's variable space, which a shared session
+    //* holds for many figures, so each figure gets its own name
+    static atomic<unsigned long> datablockCount(0);
+    this->datablockName = "$EGGP" + to_string(++datablockCount);
+
+    //* Test if terminal exists (gnuplot is probed once per process)
+    auto probeBegin = ExecRecorder::Clock::now();
+    const TerminalProbe &probe = TerminalProbe::instance();
+    this->probeSeconds = chrono::duration<double>(ExecRecorder::Clock::now() - probeBegin).count();
+    this->recorder = make_shared<ExecRecorder>(this->probeSeconds);
+    this->existsAqua   = probe.hasTerminal("aqua");
+    this->existsWxt    = probe.hasTerminal("wxt");
+    this->existsCairo  = probe.hasTerminal("cairo");
+    this->existsCanvas = probe.hasTerminal("canvas");
+    this->existsSvg    = probe.hasTerminal("svg");
+    this->hasDatablocks = atoi(probe.version().c_str()) >= 5;
 
     //* Set up modes
     flagScreen = (SCREEN & mode) ? true : false;
@@ -69,12 +164,17 @@ void Eggplot::legend(std::initializer_list<string> legendVec)
 
 void Eggplot::linespec(unsigned lineIndex, LineSpecInput lineSpec)
 {
-    //* Store but no process
+    //* Checked here so that a bad property throws now, applied at exec()
 
     if (lineIndex<=0) {
         throw out_of_range("Line index must be a positive integer");
     }
 
+    LineSpec check(lineIndex);
+    for (auto it=lineSpec.begin(); it!=lineSpec.end(); ++it) {
+        check.set(*it);
+    }
+
     this->lineSpecInput.push_back({lineIndex, lineSpec});
 }
 
@@ -94,10 +194,98 @@ void Eggplot::grid(bool flag)
     this->isGridded = flag;
 }
 
+void Eggplot::binary(bool flag)
+{
+    this->isBinary = flag;
+}
+
+void Eggplot::precision(unsigned digits)
+{
+    if (digits > maxPrecision) {
+        throw out_of_range("Precision must be at most " + to_string(maxPrecision) + " digits");
+    }
+    this->defaultPrecision = digits;
+    this->curvePrecision.clear();
+}
+
+void Eggplot::precision(unsigned lineIndex, unsigned digits)
+{
+    if (lineIndex<=0) {
+        throw out_of_range("Line index must be a positive integer");
+    }
+    if (digits > maxPrecision) {
+        throw out_of_range("Precision must be at most " + to_string(maxPrecision) + " digits");
+    }
+    this->curvePrecision[lineIndex] = digits;
+}
+
+void Eggplot::session(bool flag)
+{
+    if (!flag) {
+        this->gnuplotSession.reset();
+    }
+    else if (!this->gnuplotSession) {
+        this->gnuplotSession = make_shared<GnuplotSession>();
+    }
+}
+
+void Eggplot::session(shared_ptr<GnuplotSession> gnuplotSession)
+{
+    this->gnuplotSession = gnuplotSession;
+}
+
+void Eggplot::native(unsigned mode)
+{
+    //* only these formats have a native backend
+    this->nativeMode = mode & (PNG | SVG);
+}
+
+void Eggplot::cache(const string &dir, unsigned long long maxBytes)
+{
+    if (dir.empty()) {
+        this->renderCache.reset();
+    }
+    else {
+        this->renderCache = make_shared<RenderCache>(dir, maxBytes);
+    }
+}
+
+void Eggplot::tempdir(const string &dir)
+{
+    this->workDir = make_shared<TempDir>(dir);
+    this->workDirParent = dir;
+    this->filenamePrefix = this->workDir->path() + "/eggp";
+}
+
+void Eggplot::threads(unsigned nThread)
+{
+    this->nThread = nThread;
+}
+
+void Eggplot::datablock(bool flag)
+{
+    this->isInline = flag;
+}
+
+void Eggplot::decimate(Decimation method, unsigned nPoint)
+{
+    this->decimation     = method;
+    this->nDecimatePoint = nPoint;
+}
+
+void Eggplot::density(unsigned nBinX, unsigned nBinY, bool isLogScale)
+{
+    //* either count 0 turns the density image off
+    const bool isOn = nBinX > 0 && nBinY > 0;
+    this->densityX     = isOn ? nBinX : 0;
+    this->densityY     = isOn ? nBinY : 0;
+    this->isDensityLog = isLogScale;
+}
+
 void Eggplot::plot(initializer_list<DataVector> il)
 {
     //* Take Matlab-like commands but only store data
-    //* Actually plotting happens at Eggplot::show()
+    //* Data file is written at Eggplot::exec() in the selected format
 
     //* check if even number of data vectors
     if (il.size() % 2){
@@ -105,23 +293,184 @@ void Eggplot::plot(initializer_list<DataVector> il)
     }
 
     //* check if columns are of equal lengths
-    ofstream fout( (this->filenamePrefix + string(".dat")).c_str() );
-    this->nCurve = 0;
     for (auto it=il.begin(); it!=il.end(); ++it) {
         auto itEven = it++;
         if (it->size()!=itEven->size()){
             throw length_error("Pairwise data vectors must have the same lengths");
         }
-        const DataVector &x = *itEven;
-        const DataVector &y = *it;
+    }
+
+    //* initializer_list elements are const and die with the call: keep copies
+    this->ownedData.assign(il.begin(), il.end());
+    this->curveData.clear();
+    this->curveData.reserve(il.size()/2);
+    for (size_t i=0; i<this->ownedData.size(); i+=2) {
+        this->curveData.push_back({DataView(this->ownedData[i]), DataView(this->ownedData[i+1])});
+    }
+    this->nCurve = this->curveData.size();
+    this->nBandCurve = 0;
+    this->envelopeLegend.clear();
+}
+
+void Eggplot::plot(initializer_list<DataView> il)
+{
+    //* Same as above but only the views are stored, no data is copied
+    plot(vector<DataView>(il));
+}
 
-        fout << "# Curve " << (this->nCurve)++ << endl;
-        for (unsigned i=0; i<x.size(); ++i) {
-            fout << x[i] << "," << y[i] << endl;
+void Eggplot::plot(const vector<DataView> &il)
+{
+    if (il.size() % 2){
+        throw length_error("Arguements must be even number of data vectors");
+    }
+    for (auto it=il.begin(); it!=il.end(); ++it) {
+        auto itEven = it++;
+        if (it->size()!=itEven->size()){
+            throw length_error("Pairwise data vectors must have the same lengths");
         }
-        fout << endl << endl;
     }
-    fout.close();
+
+    this->ownedData.clear();
+    this->curveData.clear();
+    this->curveData.reserve(il.size()/2);
+    for (auto it=il.begin(); it!=il.end(); ++it) {
+        auto itEven = it++;
+        this->curveData.push_back({*itEven, *it});
+    }
+    this->nCurve = this->curveData.size();
+    this->nBandCurve = 0;
+    this->envelopeLegend.clear();
+}
+
+void Eggplot::plot(const DataVector &x, initializer_list<DataVector> ys)
+{
+    //* x is kept once, in front of the y vectors
+    for (auto it=ys.begin(); it!=ys.end(); ++it) {
+        if (it->size()!=x.size()){
+            throw length_error("Data vectors must have the same length as x");
+        }
+    }
+
+    this->ownedData.clear();
+    this->ownedData.reserve(ys.size()+1);
+    this->ownedData.push_back(x);
+    this->ownedData.insert(this->ownedData.end(), ys.begin(), ys.end());
+    this->curveData.clear();
+    this->curveData.reserve(ys.size());
+    for (size_t i=1; i<this->ownedData.size(); ++i) {
+        this->curveData.push_back({DataView(this->ownedData[0]), DataView(this->ownedData[i])});
+    }
+    this->nCurve = this->curveData.size();
+    this->nBandCurve = 0;
+    this->envelopeLegend.clear();
+}
+
+void Eggplot::plot(const DataView &x, initializer_list<DataView> ys)
+{
+    //* Same as above but only the views are stored, no data is copied
+    for (auto it=ys.begin(); it!=ys.end(); ++it) {
+        if (it->size()!=x.size()){
+            throw length_error("Data vectors must have the same length as x");
+        }
+    }
+
+    this->ownedData.clear();
+    this->curveData.clear();
+    this->curveData.reserve(ys.size());
+    for (auto it=ys.begin(); it!=ys.end(); ++it) {
+        this->curveData.push_back({x, *it});
+    }
+    this->nCurve = this->curveData.size();
+    this->nBandCurve = 0;
+    this->envelopeLegend.clear();
+}
+
+void Eggplot::plot(const double *x, const double *y, size_t n, size_t strideX, size_t strideY)
+{
+    plot({DataView(x, n, strideX), DataView(y, n, strideY)});
+}
+
+void Eggplot::envelope(const DataView &x, const vector<DataView> &ys, initializer_list<double> quantiles)
+{
+    //* The series are reduced here, once, so that only the few curves of
+    //* the envelope are kept, written and cached, however many there were.
+    if (ys.empty()) {
+        throw length_error("An envelope needs at least one data vector");
+    }
+    for (auto it=ys.begin(); it!=ys.end(); ++it) {
+        if (it->size()!=x.size()){
+            throw length_error("Data vectors must have the same length as x");
+        }
+    }
+    vector<double> bandQuantiles(quantiles);
+    sort(bandQuantiles.begin(), bandQuantiles.end());
+    for (auto it=bandQuantiles.begin(); it!=bandQuantiles.end(); ++it) {
+        if (!(*it > 0 && *it < 0.5)) {
+            throw out_of_range("Envelope quantiles must lie between 0 and 0.5");
+        }
+    }
+
+    //* ascending: the lower bounds of the bands, the median, the upper bounds
+    const size_t nQuantile = bandQuantiles.size();
+    vector<double> levels(bandQuantiles);
+    levels.push_back(0.5);
+    for (auto it=bandQuantiles.rbegin(); it!=bandQuantiles.rend(); ++it) {
+        levels.push_back(1 - *it);
+    }
+    EnvelopeStats stats;
+    computeEnvelope(ys, levels, this->nThread, stats);
+
+    //* a band is a polygon along its lower bound and back along its upper
+    //* one, so that it is a plain curve to every data layout; min-max first
+    //* and the narrowest band last, so that the narrower ones come on top
+    const size_t n = x.size();
+    const size_t nBand = nQuantile + 1;
+    this->ownedData.assign(nBand + 4, DataVector());
+    DataVector &xLine = this->ownedData[0];
+    DataVector &xBand = this->ownedData[1];
+    xLine.resize(n);
+    xBand.resize(2*n);
+    for (size_t j=0; j<n; ++j) {
+        xLine[j] = x[j];
+        xBand[j] = x[j];
+        xBand[2*n-1-j] = x[j];
+    }
+    auto makeBand = [n](DataVector &band, const DataVector &lower, const DataVector &upper) {
+        band.resize(2*n);
+        for (size_t j=0; j<n; ++j) {
+            band[j] = lower[j];
+            band[2*n-1-j] = upper[j];
+        }
+    };
+    makeBand(this->ownedData[2], stats.minimum, stats.maximum);
+    for (size_t k=0; k<nQuantile; ++k) {
+        makeBand(this->ownedData[3+k], stats.quantile[k], stats.quantile[levels.size()-1-k]);
+    }
+    this->ownedData[nBand+2].swap(stats.quantile[nQuantile]);
+    this->ownedData[nBand+3].swap(stats.mean);
+
+    this->curveData.clear();
+    this->curveData.reserve(nBand + 2);
+    for (size_t i=0; i<nBand; ++i) {
+        this->curveData.push_back({DataView(xBand), DataView(this->ownedData[2+i])});
+    }
+    this->curveData.push_back({DataView(xLine), DataView(this->ownedData[nBand+2])});
+    this->curveData.push_back({DataView(xLine), DataView(this->ownedData[nBand+3])});
+    this->nCurve = this->curveData.size();
+    this->nBandCurve = nBand;
+
+    this->envelopeLegend.clear();
+    this->envelopeLegend.push_back("min-max");
+    for (auto it=bandQuantiles.begin(); it!=bandQuantiles.end(); ++it) {
+        this->envelopeLegend.push_back(percentRange(*it));
+    }
+    this->envelopeLegend.push_back("median");
+    this->envelopeLegend.push_back("mean");
+}
+
+void Eggplot::envelope(const DataVector &x, const vector<DataVector> &ys, initializer_list<double> quantiles)
+{
+    envelope(DataView(x), vector<DataView>(ys.begin(), ys.end()), quantiles);
 }
 
 void Eggplot::print(const string &filenameExport)
@@ -129,71 +478,433 @@ void Eggplot::print(const string &filenameExport)
     this->filenameExport = filenameExport;
 }
 
+void Eggplot::stream(size_t capacity, double interval)
+{
+    if (capacity==0) {
+        throw invalid_argument("Stream capacity must be a positive integer");
+    }
+    this->streamCapacity = capacity;
+    this->streamInterval = interval;
+    this->streamX.clear();
+    this->streamY.clear();
+
+    //* refreshes only ever send the retained points, through one process
+    this->isInline = true;
+    if (!this->gnuplotSession) {
+        this->gnuplotSession = make_shared<GnuplotSession>();
+    }
+}
+
+void Eggplot::append(unsigned lineIndex, double x, double y)
+{
+    if (this->streamCapacity==0) {
+        throw logic_error("stream() must be called before append()");
+    }
+    if (lineIndex<=0) {
+        throw out_of_range("Line index must be a positive integer");
+    }
+
+    while (this->streamX.size() < lineIndex) {
+        this->streamX.push_back(RingBuffer<double>(this->streamCapacity));
+        this->streamY.push_back(RingBuffer<double>(this->streamCapacity));
+    }
+    this->streamX[lineIndex-1].push(x);
+    this->streamY[lineIndex-1].push(y);
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - this->lastRefresh;
+    if (elapsed.count() >= this->streamInterval) {
+        refresh();
+    }
+}
+
+void Eggplot::refresh()
+{
+    if (this->streamX.empty()) {
+        return;
+    }
+
+    //* the retained window is laid out contiguously in reused buffers, so
+    //* a refresh costs O(capacity) however long the stream has been
+    size_t nStream = this->streamX.size();
+    this->ownedData.resize(2*nStream);
+    this->curveData.resize(nStream);
+    for (size_t i=0; i<nStream; ++i) {
+        this->streamX[i].copyTo(this->ownedData[2*i]);
+        this->streamY[i].copyTo(this->ownedData[2*i+1]);
+        this->curveData[i] = {DataView(this->ownedData[2*i]), DataView(this->ownedData[2*i+1])};
+    }
+    this->nCurve = nStream;
+    this->nBandCurve = 0;
+    this->envelopeLegend.clear();
+
+    exec();
+    this->lastRefresh = chrono::steady_clock::now();
+}
+
 void Eggplot::exec(bool run_gnuplot)
 {
     //* Check if there are data
     if (this->nCurve==0) {
         return;
     }
-    //* Check if legend size is zero
-    else if (this->legendVec.size()==0) {
-        this->legendVec.resize(this->nCurve);
-        for (unsigned i=0; i<this->nCurve; ++i) {
-            this->legendVec[i] = to_string(i+1);
+
+    this->recorder = make_shared<ExecRecorder>(this->probeSeconds);
+    try {
+        ExecRecorder::Scope total(*this->recorder, &ExecStats::total, "exec");
+
+        //* outputs of an unchanged figure are copied from the cache
+        string key;
+        unsigned cachedMode = 0;
+        if (this->renderCache && run_gnuplot) {
+            ExecRecorder::Scope stage(*this->recorder, &ExecStats::cache, "cache");
+            key = cacheKey();
+            cachedMode = fetchCached(key);
+        }
+
+        if (cachedMode != outputModes()) {
+            execStages(run_gnuplot, cachedMode);
+            if (!key.empty()) {
+                ExecRecorder::Scope stage(*this->recorder, &ExecStats::cache, "cache");
+                storeCached(key, cachedMode);
+            }
+        }
+    }
+    catch (...) {
+        //* the trace of a failed exec() is the interesting one; the
+        //* original error takes precedence over a failure to write it
+        if (!this->traceFilename.empty()) {
+            try {
+                this->recorder->writeTrace(this->traceFilename);
+            }
+            catch (...) {
+            }
         }
+        throw;
     }
-    //* Check if legend size matches data pair number. If not, pad it.
-    else if (this->legendVec.size()!=this->nCurve) {
-        //throw length_error("Legends must match the number of data vector pairs");
-        unsigned nLegend = this->legendVec.size();
-        this->legendVec.resize(this->nCurve);
-        for (unsigned i=nLegend; i<nCurve; ++i) {
-            this->legendVec[i] = "Data " + to_string(i+1);
+    if (!this->traceFilename.empty()) {
+        this->recorder->writeTrace(this->traceFilename);
+    }
+    release();
+}
+
+void Eggplot::execStages(bool run_gnuplot, unsigned cachedMode)
+{
+    {
+        ExecRecorder::Scope stage(*this->recorder, &ExecStats::prepare, "prepare");
+        prepare();
+    }
+
+    //* native backends read the curves directly
+    if (!isNativeOnly(cachedMode)) {
+        ExecRecorder::Scope stage(*this->recorder, &ExecStats::data, "data");
+        if (this->isInline) {
+            if (run_gnuplot) {
+                prepareInlineData();
+            }
+        }
+        else {
+            writeData();
+        }
+    }
+
+    {
+        ExecRecorder::Scope stage(*this->recorder, &ExecStats::script, "script");
+        generateJobs(cachedMode);
+    }
+    {
+        ExecRecorder::Scope stage(*this->recorder, &ExecStats::render, "render");
+        runJobs(run_gnuplot);
+    }
+}
+
+ExecStats Eggplot::stats() const
+{
+    return this->recorder->stats();
+}
+
+void Eggplot::trace(const string &filename)
+{
+    this->traceFilename = filename;
+}
+
+unsigned Eggplot::outputModes() const
+{
+    return (flagScreen ? SCREEN : 0) | (flagPng ? PNG : 0) | (flagEps ? EPS : 0)
+         | (flagPdf ? PDF : 0) | (flagHtml ? HTML : 0) | (flagSvg ? SVG : 0);
+}
+
+bool Eggplot::isNativeOnly(unsigned cachedMode) const
+{
+    return (outputModes() & ~cachedMode & ~this->nativeMode) == 0;
+}
+
+void Eggplot::prepare()
+{
+    //* The legends given by legend() are kept as they are, so that the
+    //* defaults follow the data of every exec(). Missing ones are the names
+    //* of the envelope() curves, or the curve numbers if no legend is given
+    //* at all, or "Data N" after the given ones.
+    const unsigned nLegend = this->legendVec.size();
+    const bool isEnvelope = this->envelopeLegend.size()==this->nCurve;
+    this->curveLegend = this->legendVec;
+    this->curveLegend.resize(this->nCurve);
+    for (unsigned i=nLegend; i<this->nCurve; ++i) {
+        if (isEnvelope) {
+            this->curveLegend[i] = this->envelopeLegend[i];
+        }
+        else if (nLegend==0) {
+            this->curveLegend[i] = to_string(i+1);
+        }
+        else {
+            this->curveLegend[i] = "Data " + to_string(i+1);
         }
     }
 
     prepareLineSpec();
+    prepareData();
+}
+
+void Eggplot::prepareInlineData()
+{
+    //* text data is sent along with every script as a datablock
+    this->inlineData.clear();
+    if (!this->isBinary) {
+        ostringstream fout;
+        writeDataText(fout);
+        this->inlineData = fout.str();
+    }
+}
+
+void Eggplot::generateJobs(unsigned cachedMode)
+{
+    this->renderJobs.clear();
+    if (this->flagScreen) {
+        gpScreen();
+    }
+    if (this->flagPng && !(cachedMode & PNG)) {
+        gpPng();
+    }
+    if (this->flagEps && !(cachedMode & EPS)) {
+        gpEps();
+    }
+    if (this->flagPdf && !(cachedMode & PDF)) {
+        gpPdf();
+    }
+    if (this->flagHtml && !(cachedMode & HTML)) {
+        gpHtml();
+    }
+    if (this->flagSvg && !(cachedMode & SVG)) {
+        gpSvg();
+    }
+}
+
+void Eggplot::release()
+{
+    this->inlineData.clear();
+    this->renderJobs.clear();
+    this->renderCurves.clear();
+    this->decimatedData.clear();
+    this->densityGrid.cells.clear();
+    this->isBinnedCurve.clear();
+}
+
+string Eggplot::batchScript()
+{
+    if (this->nCurve==0) {
+        return "";
+    }
+
+    //* everything inline: the batch must not depend on this figure's files
+    this->isInline = true;
+    this->recorder = make_shared<ExecRecorder>(this->probeSeconds);
+    prepare();
+    prepareInlineData();
+    generateJobs();
+
+    string script;
+    for (auto it=this->renderJobs.begin(); it!=this->renderJobs.end(); ++it) {
+        if (it->isNative) {
+            renderNative(*it);
+        }
+        else {
+            script += inlineScript(*it);
+        }
+    }
+    release();
+    return script;
+}
+
+future<void> Eggplot::execAsync()
+{
+    //* The render works on a snapshot that owns its data, so the caller
+    //* may change or free its buffers and this figure right away.
+    shared_ptr<Eggplot> snapshot = make_shared<Eggplot>(*this);
+    snapshot->ownData();
+
+    //* figures in flight must not share files with this one or each other
+    if (!snapshot->isInline) {
+        snapshot->tempdir(this->workDirParent);
+    }
+
+    return RenderPool::instance().submit([snapshot]() { snapshot->exec(); });
+}
+
+void Eggplot::runJobs(bool run_gnuplot)
+{
+    //* A session is a single gnuplot process, so jobs sent to it cannot
+    //* overlap; otherwise every file export gets its own process.
+    unsigned nThread = this->nThread;
+    if (this->gnuplotSession || !run_gnuplot) {
+        nThread = 1;
+    }
+
+    shared_ptr<GnuplotSession> session = this->gnuplotSession;
+    if (!session && this->isInline && nThread==1 && run_gnuplot) {
+        session = make_shared<GnuplotSession>();
+    }
+
+    vector<string> errors(this->renderJobs.size());
+    auto runJob = [&](size_t i) {
+        auto begin = ExecRecorder::Clock::now();
+        try {
+            gpRun(this->renderJobs[i], session, run_gnuplot);
+        }
+        catch (const exception &e) {
+            errors[i] = this->renderJobs[i].mode + ": " + e.what();
+        }
+        this->recorder->mode(this->renderJobs[i].mode, begin);
+    };
 
+    //* the screen stays on the calling thread; file exports run concurrently
+    size_t first = 0;
     if (this->flagScreen) {
-        gpScreen(run_gnuplot);
+        runJob(0);
+        first = 1;
     }
-    if (this->flagPng) {
-        gpPng(run_gnuplot);
+    parallelFor(this->renderJobs.size()-first, nThread,
+                [&](size_t i) { runJob(first+i); });
+
+    string message;
+    for (auto it=errors.begin(); it!=errors.end(); ++it) {
+        if (!it->empty()) {
+            message += (message.empty() ? "" : "; ") + *it;
+        }
     }
-    if (this->flagEps) {
-        gpEps(run_gnuplot);
+    if (!message.empty()) {
+        throw runtime_error("gnuplot failed: " + message);
     }
-    if (this->flagPdf) {
-        gpPdf(run_gnuplot);
+}
+
+
+void Eggplot::prepareData()
+{
+    this->renderCurves = this->curveData;
+    prepareDensity();
+    if (this->decimation == NO_DECIMATION) {
+        return;
     }
-    if (this->flagHtml) {
-        gpHtml(run_gnuplot);
+
+    //* enough points for two per pixel column of a default-sized terminal
+    size_t nPoint = (this->nDecimatePoint > 0) ? this->nDecimatePoint
+                                               : 2*defaultTerminalWidth;
+
+    //* curves are independent, so they are reduced in parallel
+    this->decimatedData.assign(2*this->nCurve, DataVector());
+    parallelFor(this->nCurve, this->nThread, [&](size_t i) {
+        const DataView &x = this->curveData[i].first;
+        const DataView &y = this->curveData[i].second;
+        //* the x of a band runs back and forth
+        if (x.size() <= nPoint || this->isBinnedCurve[i] || isBand(i)) {
+            return;
+        }
+        DataVector &xOut = this->decimatedData[2*i];
+        DataVector &yOut = this->decimatedData[2*i+1];
+        if (this->decimation == LTTB) {
+            decimateLttb(x, y, nPoint, xOut, yOut);
+        }
+        else {
+            decimateMinMax(x, y, nPoint/2, xOut, yOut);
+        }
+        this->renderCurves[i] = {DataView(xOut), DataView(yOut)};
+    });
+}
+
+void Eggplot::prepareDensity()
+{
+    //* point-only curves are binned into one image instead of being handed
+    //* to gnuplot point by point; the native backends still draw each point
+    this->isBinnedCurve.assign(this->nCurve, false);
+    this->densityGrid.cells.clear();
+    if (this->densityX == 0 || isNativeOnly()) {
+        return;
     }
-    if (this->flagSvg) {
-        gpSvg(run_gnuplot);
+
+    vector<pair<DataView, DataView>> points;
+    for (unsigned i=0; i<this->nCurve; ++i) {
+        if (this->lineSpec[i].isPointOnly() && !isBand(i)) {
+            this->isBinnedCurve[i] = true;
+            points.push_back(this->curveData[i]);
+            this->renderCurves[i] = {DataView(), DataView()};
+        }
+    }
+    if (!points.empty()) {
+        binDensity(points, this->densityX, this->densityY, this->nThread, this->densityGrid);
     }
 }
 
+bool Eggplot::isBinned(unsigned iCurve) const
+{
+    return iCurve < this->isBinnedCurve.size() && this->isBinnedCurve[iCurve];
+}
 
-bool Eggplot::existsTerminal(string terminalName)
+bool Eggplot::isBand(unsigned iCurve) const
 {
-    bool result = false;
+    return iCurve < this->nBandCurve;
+}
 
-    string commandTest = "gnuplot -e \"set print '"+this->filenamePrefix
-            +"-exists-" + terminalName + "'; if (strstrt(GPVAL_TERMINALS, '" + terminalName + "')) print 1; else print 0\"";
-    system(commandTest.c_str());
+void Eggplot::ownData()
+{
+    //* a shared x is copied once, so the copy is still written as columns
+    vector<DataVector> data(2*this->nCurve);
+    vector<bool> isShared(this->nCurve, false);
+    for (unsigned i=0; i<this->nCurve; ++i) {
+        const DataView &x = this->curveData[i].first;
+        const DataView &y = this->curveData[i].second;
+        isShared[i] = i>0 && isSameView(x, this->curveData[0].first);
+        if (!isShared[i]) {
+            data[2*i].resize(x.size());
+            for (size_t j=0; j<x.size(); ++j) {
+                data[2*i][j] = x[j];
+            }
+        }
+        data[2*i+1].resize(y.size());
+        for (size_t j=0; j<y.size(); ++j) {
+            data[2*i+1][j] = y[j];
+        }
+    }
 
-    ifstream fin((this->filenamePrefix+"-exists-"+terminalName).c_str());
-    fin >> result;
-    fin.close();
+    this->ownedData.swap(data);
+    for (unsigned i=0; i<this->nCurve; ++i) {
+        const DataVector &x = this->ownedData[isShared[i] ? 0 : 2*i];
+        this->curveData[i] = {DataView(x), DataView(this->ownedData[2*i+1])};
+    }
+}
 
-    return result;
+string Eggplot::workFile(const string &suffix)
+{
+    if (this->workDir) {
+        return this->workDir->file("eggp" + suffix);
+    }
+    return this->filenamePrefix + suffix;
 }
 
 void Eggplot::prepareLineSpec()
 {
-    LineSpec::resetLineCount();
-    this->lineSpec.resize(nCurve);
+    this->lineSpec.clear();
+    this->lineSpec.reserve(nCurve);
+    for (unsigned i=0; i<nCurve; ++i) {
+        this->lineSpec.push_back(LineSpec(i+1));
+    }
 
     for (auto it=lineSpecInput.begin(); it!=lineSpecInput.end(); ++it) {
         unsigned lineIndex = it->first;
@@ -206,15 +917,212 @@ void Eggplot::prepareLineSpec()
     }
 }
 
-void foutGridSetting(ofstream &fout, TerminalType tt) {
+bool Eggplot::isCurveBlocks() const
+{
+    //* separate curves as text go into one datablock each, so that every
+    //* plot clause reads its own curve only; "index i" makes gnuplot rescan
+    //* the data set from the top for each. A file of datablocks is loaded,
+    //* which needs gnuplot 5.0.
+    return !this->isBinary && !isColumnar() && (this->isInline || this->hasDatablocks);
+}
+
+string Eggplot::curveBlock(unsigned iCurve) const
+{
+    return this->datablockName + "_" + to_string(iCurve);
+}
+
+string Eggplot::undefineData() const
+{
+    if (isCurveBlocks()) {
+        string command = "undefine";
+        for (unsigned i=0; i<this->nCurve; ++i) {
+            command += " " + curveBlock(i);
+        }
+        return command + "\n";
+    }
+    //* the columns of curves sharing x, sent inline
+    if (this->isInline && !this->isBinary) {
+        return "undefine " + this->datablockName + "\n";
+    }
+    return "";
+}
+
+bool Eggplot::isColumnar() const
+{
+    //* curves sharing one x are written once as columns x,y1,...,yN;
+    //* inline binary data is read once per curve and cannot be shared
+    if (this->renderCurves.size() < 2 || (this->isInline && this->isBinary)) {
+        return false;
+    }
+    for (auto it=this->renderCurves.begin()+1; it!=this->renderCurves.end(); ++it) {
+        if (!isSameView(it->first, this->renderCurves.front().first)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+string Eggplot::cacheKey() const
+{
+    //* everything the outputs depend on, except for the mode; gnuplot's
+    //* version and terminals as they shape the scripts
+    const TerminalProbe &probe = TerminalProbe::instance();
+    Hasher hasher;
+    hasher.add(version);
+    hasher.add(probe.version());
+    hasher.add(probe.terminals());
+    hasher.add(this->labelX);
+    hasher.add(this->labelY);
+    hasher.add(this->labelTitle);
+    hasher.add(static_cast<uint64_t>(this->legendVec.size()));
+    for (auto it=this->legendVec.begin(); it!=this->legendVec.end(); ++it) {
+        hasher.add(*it);
+    }
+    hasher.add(static_cast<uint64_t>(this->lineSpecInput.size()));
+    for (auto it=this->lineSpecInput.begin(); it!=this->lineSpecInput.end(); ++it) {
+        hasher.add(static_cast<uint64_t>(it->first));
+        hasher.add(static_cast<uint64_t>(it->second.size()));
+        for (auto itProperty=it->second.begin(); itProperty!=it->second.end(); ++itProperty) {
+            hasher.add(static_cast<uint64_t>(itProperty->first));
+            hasher.add(itProperty->second);
+        }
+    }
+    hasher.add(static_cast<uint64_t>(this->isGridded));
+    hasher.add(static_cast<uint64_t>(this->isBinary));
+    hasher.add(static_cast<uint64_t>(this->defaultPrecision));
+    hasher.add(static_cast<uint64_t>(this->curvePrecision.size()));
+    for (auto it=this->curvePrecision.begin(); it!=this->curvePrecision.end(); ++it) {
+        hasher.add(static_cast<uint64_t>(it->first));
+        hasher.add(static_cast<uint64_t>(it->second));
+    }
+    hasher.add(static_cast<uint64_t>(this->decimation));
+    hasher.add(static_cast<uint64_t>(this->nDecimatePoint));
+    hasher.add(static_cast<uint64_t>(this->densityX));
+    hasher.add(static_cast<uint64_t>(this->densityY));
+    hasher.add(static_cast<uint64_t>(this->isDensityLog));
+    hasher.add(static_cast<uint64_t>(this->nativeMode));
+    hasher.add(static_cast<uint64_t>(this->nBandCurve));
+    for (auto it=this->envelopeLegend.begin(); it!=this->envelopeLegend.end(); ++it) {
+        hasher.add(*it);
+    }
+    hasher.add(static_cast<uint64_t>(this->nCurve));
+    for (unsigned i=0; i<this->nCurve; ++i) {
+        hasher.add(this->curveData[i].first);
+        hasher.add(this->curveData[i].second);
+    }
+    return hasher.hex();
+}
+
+unsigned Eggplot::fetchCached(const string &key)
+{
+    unsigned cachedMode = 0;
+    unsigned nHit = 0;
+    for (unsigned i=0; i<sizeof(fileModes)/sizeof(fileModes[0]); ++i) {
+        const FileMode &fileMode = fileModes[i];
+        if ((outputModes() & fileMode.mode)
+                && this->renderCache->fetch(key + fileMode.extension,
+                                            this->filenameExport + fileMode.extension)) {
+            cachedMode |= fileMode.mode;
+            ++nHit;
+        }
+    }
+    this->recorder->addCacheHits(nHit);
+    return cachedMode;
+}
+
+void Eggplot::storeCached(const string &key, unsigned cachedMode)
+{
+    for (unsigned i=0; i<sizeof(fileModes)/sizeof(fileModes[0]); ++i) {
+        const FileMode &fileMode = fileModes[i];
+        if ((outputModes() & ~cachedMode & fileMode.mode)) {
+            this->renderCache->store(key + fileMode.extension,
+                                     this->filenameExport + fileMode.extension);
+        }
+    }
+}
+
+vector<unsigned> Eggplot::curveDigits() const
+{
+    vector<unsigned> digits(this->nCurve, this->defaultPrecision);
+    for (auto it=this->curvePrecision.begin(); it!=this->curvePrecision.end(); ++it) {
+        if (it->first <= this->nCurve) {
+            digits[it->first-1] = it->second;
+        }
+    }
+    return digits;
+}
+
+void Eggplot::writeData()
+{
+    //* written in place through a memory mapping, curves in parallel; the
+    //* layout is the same as writeDataText() and writeDataBinary()
+    string filename = workFile(".dat");
+    size_t nByte;
+    if (isColumnar()) {
+        nByte = this->isBinary
+                ? writeDataFileColumnsBinary(filename, this->renderCurves, this->nThread)
+                : writeDataFileColumnsText(filename, this->renderCurves, this->nThread, curveDigits());
+    }
+    else {
+        nByte = this->isBinary
+                ? writeDataFileBinary(filename, this->renderCurves, this->nThread)
+                : writeDataFileText(filename, this->renderCurves, this->nThread, curveDigits(),
+                                    isCurveBlocks() ? this->datablockName : string());
+    }
+    if (!this->densityGrid.cells.empty()) {
+        nByte += writeDensityFile(workFile("-density.dat"), this->densityGrid);
+    }
+
+    size_t nPoint = 0;
+    for (auto it=this->renderCurves.begin(); it!=this->renderCurves.end(); ++it) {
+        nPoint += it->first.size();
+    }
+    this->recorder->addBytes(nByte);
+    this->recorder->addPoints(nPoint);
+}
+
+void Eggplot::writeDataText(ostream &fout)
+{
+    //* Formatted on all threads as writeDataFileText() and the columnar
+    //* writer, in datablocks: one per curve, or one of columns
+    if (isColumnar()) {
+        fout << this->datablockName << " << EOD\n";
+        writeDataStreamColumnsText(fout, this->renderCurves, this->nThread, curveDigits());
+        fout << "EOD\n";
+        this->recorder->addPoints(this->renderCurves.front().first.size()*this->nCurve);
+        return;
+    }
+
+    writeDataStreamText(fout, this->renderCurves, this->nThread, curveDigits(), this->datablockName);
+    for (auto it=this->renderCurves.begin(); it!=this->renderCurves.end(); ++it) {
+        this->recorder->addPoints(it->first.size());
+    }
+}
+
+void Eggplot::writeDataBinary(ostream &fout)
+{
+    //* Curves are stored back to back as interleaved float64 (x,y) records,
+    //* one '-' clause each in gpCurve(); binned curves have no clause
+    vector<pair<DataView, DataView>> curves;
+    curves.reserve(this->nCurve);
+    for (unsigned iCurve=0; iCurve<this->nCurve; ++iCurve) {
+        if (!isBinned(iCurve)) {
+            curves.push_back(this->renderCurves[iCurve]);
+            this->recorder->addPoints(this->renderCurves[iCurve].first.size());
+        }
+    }
+    writeDataStreamBinary(fout, curves, this->nThread);
+}
+
+void foutGridSetting(ostream &fout, TerminalType tt) {
     fout << "set grid lc rgb '" << LineSpec::gridColor << "' lw 1 lt " << LineSpec::getGridLineType(tt) << endl;
 }
 
-void Eggplot::gpScreen(bool run_gnuplot)
+void Eggplot::gpScreen()
 {
     //* Generate gnuplot batch file
-    string filename = this->filenamePrefix+".gp";
-    ofstream fout(filename.c_str());
+    string filename = workFile(".gp");
+    ostringstream fout;
 
     gpHeader(fout);
 
@@ -246,18 +1154,22 @@ void Eggplot::gpScreen(bool run_gnuplot)
             fout << this->lineSpec[i].toStringWxtCairoSvg() << endl;
         }
     }
-    gpCurve(fout, filename, run_gnuplot);
-
-    fout.close();
+    gpCurve(fout);
+    this->renderJobs.push_back({"SCREEN", fout.str(), filename, false});
 
 }
 
-void Eggplot::gpPng(bool run_gnuplot)
+void Eggplot::gpPng()
 {
+    if (this->nativeMode & PNG) {
+        this->renderJobs.push_back({"PNG", "", this->filenameExport+".png", true});
+        return;
+    }
+
     //* Generate gnuplot batch file
-    string filename = this->filenamePrefix+"-png.gp";
+    string filename = workFile("-png.gp");
     string filenameExport = this->filenameExport+".png";
-    ofstream fout(filename.c_str());
+    ostringstream fout;
 
     gpHeader(fout);
 
@@ -284,17 +1196,16 @@ void Eggplot::gpPng(bool run_gnuplot)
             fout << this->lineSpec[i].toStringWxtCairoSvg() << endl;
         }
     }
-    gpCurve(fout, filename, run_gnuplot);
-
-    fout.close();
+    gpCurve(fout);
+    this->renderJobs.push_back({"PNG", fout.str(), filename, false});
 }
 
-void Eggplot::gpEps(bool run_gnuplot)
+void Eggplot::gpEps()
 {
     //* Generate gnuplot batch file
-    string filename = this->filenamePrefix+"-eps.gp";
+    string filename = workFile("-eps.gp");
     string filenameExport = this->filenameExport+".eps";
-    ofstream fout(filename.c_str());
+    ostringstream fout;
 
     gpHeader(fout);
 
@@ -324,17 +1235,16 @@ void Eggplot::gpEps(bool run_gnuplot)
         }
     }
 
-    gpCurve(fout, filename, run_gnuplot);
-
-    fout.close();
+    gpCurve(fout);
+    this->renderJobs.push_back({"EPS", fout.str(), filename, false});
 }
 
-void Eggplot::gpPdf(bool run_gnuplot)
+void Eggplot::gpPdf()
 {
     //* Generate gnuplot batch file
-    string filename = this->filenamePrefix+"-pdf.gp";
+    string filename = workFile("-pdf.gp");
     string filenameExport = this->filenameExport+".pdf";
-    ofstream fout(filename.c_str());
+    ostringstream fout;
 
     gpHeader(fout);
 
@@ -350,17 +1260,16 @@ void Eggplot::gpPdf(bool run_gnuplot)
         }
     }
 
-    gpCurve(fout, filename, run_gnuplot);
-
-    fout.close();
+    gpCurve(fout);
+    this->renderJobs.push_back({"PDF", fout.str(), filename, false});
 }
 
-void Eggplot::gpHtml(bool run_gnuplot)
+void Eggplot::gpHtml()
 {
     //* Generate gnuplot batch file
-    string filename = this->filenamePrefix+"-html.gp";
+    string filename = workFile("-html.gp");
     string filenameExport = this->filenameExport+".html";
-    ofstream fout(filename.c_str());
+    ostringstream fout;
 
     gpHeader(fout);
 
@@ -376,17 +1285,21 @@ void Eggplot::gpHtml(bool run_gnuplot)
         }
     }
 
-    gpCurve(fout, filename, run_gnuplot);
-
-    fout.close();
+    gpCurve(fout);
+    this->renderJobs.push_back({"HTML", fout.str(), filename, false});
 }
 
-void Eggplot::gpSvg(bool run_gnuplot)
+void Eggplot::gpSvg()
 {
+    if (this->nativeMode & SVG) {
+        this->renderJobs.push_back({"SVG", "", this->filenameExport+".svg", true});
+        return;
+    }
+
     //* Generate gnuplot batch file
-    string filename = this->filenamePrefix+"-svg.gp";
+    string filename = workFile("-svg.gp");
     string filenameExport = this->filenameExport+".svg";
-    ofstream fout(filename.c_str());
+    ostringstream fout;
 
     gpHeader(fout);
 
@@ -402,20 +1315,19 @@ void Eggplot::gpSvg(bool run_gnuplot)
         }
     }
 
-    gpCurve(fout, filename, run_gnuplot);
-
-    fout.close();
+    gpCurve(fout);
+    this->renderJobs.push_back({"SVG", fout.str(), filename, false});
 
 }
 
-void Eggplot::gpHeader(ofstream &fout)
+void Eggplot::gpHeader(ostream &fout)
 {
     fout << "# Gnuplot script file" << endl;
     fout << "# Automatically generated by eggplot Ver. " << version << endl;
     fout << "set datafile separator ','" << endl;
 }
 
-void Eggplot::gpCurve(ofstream &fout, const string &filename, bool run_gnuplot)
+void Eggplot::gpCurve(ostream &fout)
 {
     fout << "set style increment userstyle" << endl;
     fout << "set autoscale" << endl;
@@ -426,16 +1338,78 @@ void Eggplot::gpCurve(ofstream &fout, const string &filename, bool run_gnuplot)
     fout << "set title \"" << this->labelTitle << "\"" << endl;
     fout << "set xlabel \"" << this->labelX << "\"" << endl;
     fout << "set ylabel \"" << this->labelY << "\"" << endl;
+
+    //* per-curve datablocks of a file are defined once for all clauses
+    const bool isCurveBlocks = this->isCurveBlocks();
+    if (isCurveBlocks && !this->isInline) {
+        fout << "load '" << this->filenamePrefix << ".dat'" << endl;
+    }
+
+    //* the density image of binned curves comes first, below all lines;
+    //* pixels are centered on their cells
+    const DensityGrid &grid = this->densityGrid;
+    const bool hasDensity = !grid.cells.empty();
+    if (hasDensity && this->isDensityLog) {
+        fout << "set logscale cb" << endl;
+    }
     fout << "plot ";
+    if (hasDensity) {
+        const double dx = (grid.xMax - grid.xMin)/grid.nx;
+        const double dy = (grid.yMax - grid.yMin)/grid.ny;
+        fout << (this->isInline ? string("'-'") : "'" + this->filenamePrefix + "-density.dat'")
+             << " binary array=(" << grid.nx << "," << grid.ny << ") format='%float64'"
+             << " dx=" << exactNumber(dx) << " dy=" << exactNumber(dy)
+             << " origin=(" << exactNumber(grid.xMin + dx/2) << "," << exactNumber(grid.yMin + dy/2) << ")"
+             << " with image notitle, ";
+    }
 
+    //* shared x: every curve reads its own column of one data set
+    const bool isColumnar = this->isColumnar();
+    string columnFormat;
+    for (unsigned i=0; isColumnar && i<=this->nCurve; ++i) {
+        columnFormat += "%float64";
+    }
+
+    size_t offset = 0;
     for (unsigned i=0; i<this->nCurve; ++i) {
 
-        string filename = this->filenamePrefix+".dat";
-        fout << "'" << filename << "' index " << i
-             << " title '" << this->legendVec[i]
+        size_t nRecord = max<size_t>(this->renderCurves[i].first.size(), 1);
+        if (isBinned(i)) {
+            //* still one undefined record in a binary file
+            offset += nRecord*2*sizeof(double);
+            continue;
+        }
+        if (isColumnar && this->isBinary) {
+            fout << "'" << this->filenamePrefix << ".dat' binary format='" << columnFormat << "'"
+                 << " record=" << nRecord << " using 1:" << i+2;
+        }
+        else if (isColumnar) {
+            fout << (this->isInline ? this->datablockName : "'" + this->filenamePrefix + ".dat'")
+                 << " using 1:" << i+2;
+        }
+        else if (this->isInline && this->isBinary) {
+            fout << "'-' binary format='%float64%float64' record=" << nRecord;
+        }
+        else if (this->isBinary) {
+            fout << "'" << this->filenamePrefix << ".dat' binary format='%float64%float64'"
+                 << " record=" << nRecord << " skip=" << offset;
+            offset += nRecord*2*sizeof(double);
+        }
+        else if (isCurveBlocks) {
+            fout << curveBlock(i);
+        }
+        else {
+            fout << "'" << this->filenamePrefix << ".dat' index " << i;
+        }
+        fout << " title '" << this->curveLegend[i]
              << "' with ";
 
-        if (this->lineSpec[i].isPointOnly()) {
+        if (isBand(i)) {
+            //* bands are shades of the median's color, darker where they overlap
+            fout << "filledcurves closed ls " << this->nBandCurve+1
+                 << " fs transparent solid " << bandOpacity << " noborder";
+        }
+        else if (this->lineSpec[i].isPointOnly()) {
             fout << "points";
         }
         else {
@@ -445,16 +1419,98 @@ void Eggplot::gpCurve(ofstream &fout, const string &filename, bool run_gnuplot)
     }
     fout << endl;
 
-    if (run_gnuplot) {
-        system(("gnuplot "+filename).c_str());
+    //* inline binary data follows the plot command that reads it
+    if (this->isInline && hasDensity) {
+        fout.write(reinterpret_cast<const char*>(grid.cells.data()), grid.cells.size()*sizeof(double));
+    }
+    if (this->isInline && this->isBinary) {
+        writeDataBinary(fout);
     }
+}
 
+void Eggplot::renderNative(const RenderJob &job) const
+{
+    FigureSpec figure;
+    figure.curves    = this->renderCurves;
+    for (unsigned i=0; i<this->nCurve; ++i) {
+        if (isBinned(i)) {
+            figure.curves[i] = this->curveData[i];
+        }
+    }
+    figure.nBand     = this->nBandCurve;
+    figure.lineSpec  = this->lineSpec;
+    figure.legend    = this->curveLegend;
+    figure.title     = this->labelTitle;
+    figure.xlabel    = this->labelX;
+    figure.ylabel    = this->labelY;
+    figure.isGridded = this->isGridded;
+
+    ofstream fout(job.filename.c_str(), ios::out | ios::binary);
+    if (job.mode=="PNG") {
+        writePng(fout, figure);
+    }
+    else {
+        writeSvg(fout, figure);
+    }
+    if (!fout) {
+        throw runtime_error("Cannot write " + job.filename);
+    }
+    this->recorder->addBytes(static_cast<unsigned long long>(fout.tellp()));
 }
 
+string Eggplot::inlineScript(const RenderJob &job) const
+{
+    //* reset leftovers of the previous figure; closing the output makes
+    //* sure the exported file is complete once gnuplot has read this
+    return "reset\n" + this->inlineData + job.script + "set output\n" + undefineData();
+}
 
+void Eggplot::gpRun(const RenderJob &job, shared_ptr<GnuplotSession> session, bool run_gnuplot) const
+{
+    if (job.isNative) {
+        if (run_gnuplot) {
+            renderNative(job);
+        }
+        return;
+    }
 
-}
+    if (this->isInline) {
+        //* nothing is written to disk; the script goes to gnuplot's stdin
+        if (run_gnuplot) {
+            if (!session) {
+                session = make_shared<GnuplotSession>();
+            }
+            string script = inlineScript(job);
+            unsigned long nProcess = session->processCount();
+            session->run(script);
+            this->recorder->addBytes(script.size());
+            this->recorder->addProcesses(session->processCount() - nProcess);
+        }
+        return;
+    }
 
+    {
+        ofstream fout(job.filename.c_str(), ios::out | ios::binary);
+        fout << job.script;
+    }
+    this->recorder->addBytes(job.script.size());
+    if (run_gnuplot) {
+        if (session) {
+            //* reset leftovers of the previous figure; closing the output
+            //* makes sure the exported file is complete on return
+            unsigned long nProcess = session->processCount();
+            session->run("reset\nload '" + job.filename + "'\nset output\n" + undefineData());
+            this->recorder->addProcesses(session->processCount() - nProcess);
+        }
+        else {
+            this->recorder->addProcesses(1);
+            if (system(("gnuplot "+job.filename).c_str()) != 0) {
+                throw runtime_error("gnuplot " + job.filename + " did not exit successfully");
+            }
+        }
+    }
+}
 
 
 
+}
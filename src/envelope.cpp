@@ -0,0 +1,114 @@
+#include "envelope.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "parallel.h"
+
+using namespace std;
+
+namespace eggp{
+
+namespace {
+
+//* doubles of a tile; a block spans at least a cache line of every series
+const size_t tileLength = 1 << 16;
+const size_t minBlockLength = 8;
+
+//* quantiles of the values [first, last), which are reordered
+void selectQuantiles(double *first, double *last, const vector<double> &levels,
+                     EnvelopeStats &stats, size_t j)
+{
+    const size_t n = last - first;
+    double *begin = first;
+    for (size_t k=0; k<levels.size(); ++k) {
+        const double h = (n-1)*levels[k];
+        const size_t lo = min(static_cast<size_t>(h), n-1);
+        nth_element(begin, first+lo, last);
+        begin = first+lo;
+
+        double value = first[lo];
+        const double fraction = h - lo;
+        if (fraction > 0 && lo+1 < n) {
+            value += fraction*(*min_element(first+lo+1, last) - value);
+        }
+        stats.quantile[k][j] = value;
+    }
+}
+
+}
+
+
+void computeEnvelope(const vector<DataView> &ys, const vector<double> &levels,
+                     unsigned nThread, EnvelopeStats &stats)
+{
+    const size_t nSeries = ys.size();
+    const size_t n = ys.empty() ? 0 : ys.front().size();
+    stats.mean.assign(n, NAN);
+    stats.minimum.assign(n, NAN);
+    stats.maximum.assign(n, NAN);
+    stats.quantile.assign(levels.size(), DataVector(n, NAN));
+    if (n == 0 || nSeries == 0) {
+        return;
+    }
+
+    if (nThread==0) {
+        nThread = defaultThreadCount();
+    }
+    const size_t blockLength = max(minBlockLength, tileLength/nSeries);
+    const size_t nBlock = (n + blockLength - 1)/blockLength;
+    const size_t nSlot = min<size_t>(nThread, nBlock);
+
+    //* every slot takes a contiguous range of blocks and reuses its tile
+    parallelFor(nSlot, nThread, [&](size_t iSlot) {
+        vector<double> tile(blockLength*nSeries);
+        vector<double> sum(blockLength);
+        vector<double> low(blockLength);
+        vector<double> high(blockLength);
+        vector<size_t> count(blockLength);
+        const double inf = numeric_limits<double>::infinity();
+
+        for (size_t iBlock=nBlock*iSlot/nSlot; iBlock<nBlock*(iSlot+1)/nSlot; ++iBlock) {
+            const size_t begin = iBlock*blockLength;
+            const size_t m = min(blockLength, n-begin);
+            fill(sum.begin(), sum.end(), 0.0);
+            fill(low.begin(), low.end(), inf);
+            fill(high.begin(), high.end(), -inf);
+            fill(count.begin(), count.end(), 0);
+
+            //* branch-free, so that the compiler can vectorize it; NaN
+            //* compares false and never wins the minimum or maximum
+            for (size_t s=0; s<nSeries; ++s) {
+                const size_t stride = ys[s].stride();
+                const double *y = ys[s].data() + begin*stride;
+                double *column = tile.data() + s;
+                for (size_t j=0; j<m; ++j) {
+                    const double v = y[j*stride];
+                    const bool isValue = (v == v);
+                    sum[j]   += isValue ? v : 0.0;
+                    count[j] += isValue;
+                    low[j]    = (v < low[j]) ? v : low[j];
+                    high[j]   = (v > high[j]) ? v : high[j];
+                    column[j*nSeries] = v;
+                }
+            }
+
+            for (size_t j=0; j<m; ++j) {
+                if (count[j] == 0) {
+                    continue;
+                }
+                stats.mean[begin+j]    = sum[j]/count[j];
+                stats.minimum[begin+j] = low[j];
+                stats.maximum[begin+j] = high[j];
+
+                double *first = tile.data() + j*nSeries;
+                double *last = remove_if(first, first+nSeries, [](double v) { return std::isnan(v); });
+                selectQuantiles(first, last, levels, stats, begin+j);
+            }
+        }
+    });
+}
+
+
+}
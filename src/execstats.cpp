@@ -0,0 +1,182 @@
+#include "execstats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #include <process.h>
+    #define getpid _getpid
+#else
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+double microseconds(ExecRecorder::Clock::duration duration)
+{
+    return chrono::duration<double, micro>(duration).count();
+}
+
+string jsonString(const string &text)
+{
+    string result = "\"";
+    for (auto it=text.begin(); it!=text.end(); ++it) {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (c=='"' || c=='\\') {
+            result += '\\';
+            result += *it;
+        }
+        else if (c < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            result += buffer;
+        }
+        else {
+            result += *it;
+        }
+    }
+    return result + "\"";
+}
+
+}
+
+
+ExecStats::ExecStats()
+    : probe(0),
+      cache(0),
+      prepare(0),
+      data(0),
+      script(0),
+      render(0),
+      total(0),
+      modes(),
+      bytesWritten(0),
+      pointsSerialized(0),
+      processesSpawned(0),
+      cacheHits(0)
+{
+}
+
+ExecRecorder::ExecRecorder(double probe)
+    : mutex(),
+      summary(),
+      events(),
+      threads(),
+      origin(Clock::now()),
+      originEpoch(chrono::duration_cast<chrono::microseconds>(
+                      chrono::system_clock::now().time_since_epoch()).count())
+{
+    this->summary.probe = probe;
+}
+
+void ExecRecorder::stage(double ExecStats::*field, const string &name, Clock::time_point begin)
+{
+    Clock::time_point end = Clock::now();
+    lock_guard<std::mutex> lock(this->mutex);
+    this->summary.*field += chrono::duration<double>(end-begin).count();
+    addEvent(name, "stage", begin, end);
+}
+
+void ExecRecorder::mode(const string &name, Clock::time_point begin)
+{
+    Clock::time_point end = Clock::now();
+    lock_guard<std::mutex> lock(this->mutex);
+    this->summary.modes[name] += chrono::duration<double>(end-begin).count();
+    addEvent(name, "render", begin, end);
+}
+
+void ExecRecorder::addBytes(unsigned long long nByte)
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    this->summary.bytesWritten += nByte;
+}
+
+void ExecRecorder::addPoints(unsigned long long nPoint)
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    this->summary.pointsSerialized += nPoint;
+}
+
+void ExecRecorder::addProcesses(unsigned nProcess)
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    this->summary.processesSpawned += nProcess;
+}
+
+void ExecRecorder::addCacheHits(unsigned nHit)
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    this->summary.cacheHits += nHit;
+}
+
+ExecStats ExecRecorder::stats() const
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    return this->summary;
+}
+
+void ExecRecorder::addEvent(const string &name, const string &category,
+                            Clock::time_point begin, Clock::time_point end)
+{
+    //* threads are numbered in order of appearance, the caller of exec() first
+    thread::id id = this_thread::get_id();
+    auto it = find(this->threads.begin(), this->threads.end(), id);
+    unsigned iThread = static_cast<unsigned>(it - this->threads.begin());
+    if (it == this->threads.end()) {
+        this->threads.push_back(id);
+    }
+    this->events.push_back({name, category, microseconds(begin-this->origin),
+                            microseconds(end-begin), iThread+1});
+}
+
+void ExecRecorder::writeTrace(const string &filename) const
+{
+    lock_guard<std::mutex> lock(this->mutex);
+
+    string json = "{\"traceEvents\":[\n";
+    char buffer[256];
+    const int pid = static_cast<int>(getpid());
+    for (size_t i=0; i<this->events.size(); ++i) {
+        const Event &event = this->events[i];
+        snprintf(buffer, sizeof(buffer),
+                 ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+                 this->originEpoch + event.begin, event.duration, pid, event.thread);
+        json += "{\"name\":" + jsonString(event.name) + ",\"cat\":" + jsonString(event.category)
+                + buffer + ((i+1 < this->events.size()) ? ",\n" : "\n");
+    }
+    snprintf(buffer, sizeof(buffer),
+             "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"bytesWritten\":%llu,"
+             "\"pointsSerialized\":%llu,\"processesSpawned\":%u,\"cacheHits\":%u}}\n",
+             this->summary.bytesWritten, this->summary.pointsSerialized,
+             this->summary.processesSpawned, this->summary.cacheHits);
+    json += buffer;
+
+    ofstream fout(filename.c_str(), ios::out | ios::binary);
+    fout << json;
+    if (!fout) {
+        throw runtime_error("Cannot write trace file " + filename);
+    }
+}
+
+ExecRecorder::Scope::Scope(ExecRecorder &recorder, double ExecStats::*field, const string &name)
+    : recorder(recorder),
+      field(field),
+      name(name),
+      begin(Clock::now())
+{
+}
+
+ExecRecorder::Scope::~Scope()
+{
+    this->recorder.stage(this->field, this->name, this->begin);
+}
+
+
+}
@@ -0,0 +1,99 @@
+#include "frame.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+using namespace std;
+
+namespace eggp{
+
+
+vector<double> Axis::ticks() const
+{
+    vector<double> result;
+    long long first = static_cast<long long>(ceil(this->lo/this->step - 1e-9));
+    long long last  = static_cast<long long>(floor(this->hi/this->step + 1e-9));
+    for (long long i=first; i<=last; ++i) {
+        double value = i*this->step;
+        result.push_back((fabs(value) < this->step*1e-9) ? 0.0 : value);
+    }
+    return result;
+}
+
+string Axis::tickLabel(double value) const
+{
+    char buffer[32];
+    double magnitude = max(fabs(this->lo), fabs(this->hi));
+    if (magnitude >= 1e6 || this->step < 1e-4) {
+        snprintf(buffer, sizeof(buffer), "%g", value);
+    }
+    else {
+        int decimals = max(0, static_cast<int>(-floor(log10(this->step) + 1e-9)));
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    }
+    return buffer;
+}
+
+Axis niceAxis(double lo, double hi, unsigned maxTicks)
+{
+    if (!(lo <= hi)) {
+        //* no finite data
+        lo = -1;
+        hi = 1;
+    }
+    if (lo == hi) {
+        //* constant data: gnuplot widens the range around the value
+        double delta = (lo==0) ? 1 : fabs(lo)*0.1;
+        lo -= delta;
+        hi += delta;
+    }
+
+    double rawStep = (hi-lo)/max(1u, maxTicks-1);
+    double power   = pow(10.0, floor(log10(rawStep)));
+    double ratio   = rawStep/power;
+    double nice    = (ratio <= 1) ? 1 : (ratio <= 2) ? 2 : (ratio <= 5) ? 5 : 10;
+
+    Axis axis;
+    axis.step = nice*power;
+    axis.lo   = floor(lo/axis.step + 1e-9)*axis.step;
+    axis.hi   = ceil(hi/axis.step - 1e-9)*axis.step;
+    return axis;
+}
+
+Frame::Frame(const FigureSpec &figure, unsigned width, unsigned height)
+{
+    double xMin =  numeric_limits<double>::infinity();
+    double xMax = -numeric_limits<double>::infinity();
+    double yMin =  numeric_limits<double>::infinity();
+    double yMax = -numeric_limits<double>::infinity();
+
+    for (auto it=figure.curves.begin(); it!=figure.curves.end(); ++it) {
+        const DataView &xData = it->first;
+        const DataView &yData = it->second;
+        for (size_t i=0; i<xData.size(); ++i) {
+            double xi = xData[i];
+            double yi = yData[i];
+            if (!std::isfinite(xi) || !std::isfinite(yi)) {
+                continue;
+            }
+            xMin = min(xMin, xi);
+            xMax = max(xMax, xi);
+            yMin = min(yMin, yi);
+            yMax = max(yMax, yi);
+        }
+    }
+    this->x = niceAxis(xMin, xMax);
+    this->y = niceAxis(yMin, yMax);
+
+    //* room for tick labels, axis labels and the title
+    const double fontHeight = 12;
+    this->left   = (figure.ylabel.empty() ? 5.0 : 7.0)*fontHeight;
+    this->right  = width - 2*fontHeight;
+    this->top    = (figure.title.empty() ? 1.5 : 3.0)*fontHeight;
+    this->bottom = height - (figure.xlabel.empty() ? 2.5 : 4.5)*fontHeight;
+}
+
+
+}
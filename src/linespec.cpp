@@ -1,32 +1,95 @@
 #include "linespec.h"
 
 #include <exception>
-#include <algorithm>
-#include <cmath>
-#include <iomanip>
-#include <map>
-#include <sstream>
+#include <cstdio>
+#include <stdexcept>
 
-#include <iostream>
+#include "color.h"
 
 using namespace std;
 
 namespace eggp{
 
 
-LineSpec::LineSpec(unsigned index) :
-    lineType("-"),
-    lineWidth(1),
-    pointType(""),
-    pointSize(1)
+namespace {
+
+//* gnuplot line type per LineType, one row per TerminalType
+constexpr int lineTypeTable[TERMINAL_TYPE_COUNT][LINE_TYPE_COUNT] = {
+    // -   --  :   -.  none
+    {  1,  2,  4,  5,  0},  // TERM_AQUA
+    {  1,  2,  3,  4,  0},  // TERM_WXT
+    {  1,  2,  3,  4,  0},  // TERM_CAIRO
+    {  1,  2,  3,  4,  0},  // TERM_SVG
+    {  1,  2,  3,  4,  0},  // TERM_CANVAS
+    {  1,  2,  3,  4,  0}   // TERM_OTHER
+};
+
+//* gnuplot point type per MarkerType, one row per TerminalType;
+//* MARKER_DEFAULT is resolved to the line index instead
+constexpr int pointTypeTable[TERMINAL_TYPE_COUNT][MARKER_TYPE_COUNT] = {
+    // def  o   +   *   .   x   s   d   ^   v   >   <   p   h  none
+    {   0,  5,  1,  3,  5,  2,  4,  5,  6,  6,  6,  6,  5,  5,  0},  // TERM_AQUA
+    {   0,  6,  1,  3,  7,  2,  4, 12,  8, 10,  9, 11,  5, 13,  0},  // TERM_WXT
+    {   0,  6,  1,  3,  7,  2,  4, 12,  8, 10,  9, 11,  5, 13,  0},  // TERM_CAIRO
+    {   0,  6,  1,  3,  7,  2,  4, 12,  8, 10,  9, 11,  5, 13,  0},  // TERM_SVG
+    {   0,  6,  1,  3,  7,  2,  4,  5,  8,  9,  8,  9,  4,  8,  0},  // TERM_CANVAS
+    {   0,  6,  1,  3,  7,  2,  4, 12,  8, 10,  9, 11,  5, 13,  0}   // TERM_OTHER
+};
+
+struct LineTypeName
+{
+    const char *name;
+    LineType    lineType;
+};
+
+constexpr LineTypeName lineTypeNames[] = {
+    {"-", LINE_SOLID}, {"--", LINE_DASHED}, {":", LINE_DOTTED}, {"-.", LINE_DASHDOT},
+    {"none", LINE_NONE}
+};
+
+struct MarkerName
+{
+    const char *name;
+    MarkerType  marker;
+};
+
+constexpr MarkerName markerNames[] = {
+    {"o", MARKER_CIRCLE}, {"+", MARKER_PLUS}, {"*", MARKER_STAR}, {".", MARKER_POINT},
+    {"x", MARKER_CROSS}, {"s", MARKER_SQUARE}, {"square", MARKER_SQUARE},
+    {"d", MARKER_DIAMOND}, {"diamond", MARKER_DIAMOND}, {"^", MARKER_UP}, {"v", MARKER_DOWN},
+    {">", MARKER_RIGHT}, {"<", MARKER_LEFT}, {"p", MARKER_PENTAGRAM},
+    {"pentagram", MARKER_PENTAGRAM}, {"h", MARKER_HEXAGRAM}, {"hexagram", MARKER_HEXAGRAM},
+    {"none", MARKER_NONE}
+};
+
+constexpr uint32_t defaultColors[] = {
+    0xfff00032,  // red
+    0xff227500,  // green
+    0xff1a3bea,  // blue
+    0xffe700f0,  // magenta
+    0xff00beb1,  // cyan
+    0xff8b4513,  // brown
+    0xfff0c000,  // yellow
+    0xff808000,  // olive
+    0xff505050,  // gray
+    0xff6b00d2   // purple
+};
+
+}
+
+
+LineSpec::LineSpec(unsigned index)
 {
     if (index==0) {
-        this->lineIndex = ++(LineSpec::lineCount);
+        throw invalid_argument("Line index must be a positive integer");
     }
-    else {
-        this->lineIndex = index;
-    }
-    this->color = LineSpec::defaultColor[(this->lineIndex-1)%LineSpec::defaultColor.size()];
+    this->record.index     = index;
+    this->record.lineType  = LINE_SOLID;
+    this->record.marker    = MARKER_DEFAULT;
+    this->record.lineWidth = 1;
+    this->record.pointSize = 1;
+    const unsigned nColor = sizeof(defaultColors)/sizeof(defaultColors[0]);
+    this->record.color     = defaultColors[(index-1)%nColor];
 }
 
 void LineSpec::set(const LineProperty property, const string &value)
@@ -36,34 +99,52 @@ void LineSpec::set(const LineProperty property, const string &value)
         if (value.empty()){
             throw invalid_argument("LineStyle cannot be empty");
         }
-        this->lineType = value;
-        break;
+        for (unsigned i=0; i<sizeof(lineTypeNames)/sizeof(lineTypeNames[0]); ++i) {
+            if (value == lineTypeNames[i].name) {
+                this->record.lineType = lineTypeNames[i].lineType;
+                return;
+            }
+        }
+        throw invalid_argument("LineStyle must be \"-\", \"--\", \":\", \"-.\", or \"none\"");
     case LineWidth:
         try{
-           this->lineWidth = stod(value);
+           this->record.lineWidth = stod(value);
         }
         catch (const invalid_argument &) {
             throw invalid_argument("LineWidth must be numeric");
         }
-        this->lineWidth = (this->lineWidth<0) ? 0 : this->lineWidth;
+        this->record.lineWidth = (this->record.lineWidth<0) ? 0 : this->record.lineWidth;
         break;
     case Marker:
-        this->pointType = value;
-        break;
+        if (value.empty()) {
+            this->record.marker = MARKER_DEFAULT;
+            return;
+        }
+        for (unsigned i=0; i<sizeof(markerNames)/sizeof(markerNames[0]); ++i) {
+            if (value == markerNames[i].name) {
+                this->record.marker = markerNames[i].marker;
+                return;
+            }
+        }
+        throw invalid_argument("Marker must be one of \"o+*.xsd^v><ph\" or \"none\"");
     case MarkerSize:
         try{
-            this->pointSize = stod(value);
+            this->record.pointSize = stod(value);
         }
         catch (const invalid_argument &) {
             throw invalid_argument("MarkerSize must be numeric");
         }
-        this->pointSize = (this->pointSize<0) ? 0 : this->pointSize;
+        this->record.pointSize = (this->record.pointSize<0) ? 0 : this->record.pointSize;
         break;
     case Color:
         if (value.empty()){
             throw invalid_argument("Color spec cannot be empty");
         }
-        this->color = value;
+        if (!parseColor(value, this->record.color)) {
+            throw invalid_argument("Color must be a name, one of \"ymcrgbwk\", \"#rrggbb\", "
+                                   "\"#aarrggbb\", integers \"(r,g,b)\" within 0-255 or "
+                                   "decimals \"[r,g,b]\" within 0.0-1.0: " + value);
+        }
         break;
     default:
         throw invalid_argument("Invalid line property");
@@ -75,296 +156,74 @@ void LineSpec::set(const std::pair<LineProperty, string> &input)
     this->set(input.first, input.second);
 }
 
+string LineSpec::toString(TerminalType tt) const
+{
+    char color[maxColorTextLength+1];
+    color[formatColor(color, this->record.color)] = '\0';
+
+    char buffer[128 + maxColorTextLength];
+    int n = snprintf(buffer, sizeof(buffer), "set style line %u lt %d lw %.3g pt %d ps %.3g lc rgb '%s'",
+                     this->record.index, lineTypeTable[tt][this->record.lineType],
+                     this->record.lineWidth, getPointType(tt), this->record.pointSize, color);
+    return string(buffer, n);
+}
+
 string LineSpec::toStringAqua() const
 {
-    string style;
-    toStringBasic(this->lineTypeMappingAqua, this->pointTypeMappingAqua, style);
-    return style;
+    return toString(TERM_AQUA);
 }
 
 string LineSpec::toStringWxtCairoSvg() const
 {
-    string style;
-    toStringBasic(this->lineTypeMappingOther, this->pointTypeMappingOther, style);
-    return style;
+    return toString(TERM_CAIRO);
 }
 
 string LineSpec::toStringHtml() const
 {
-    string style;
-    toStringBasic(this->lineTypeMappingOther, this->pointTypeMappingCanvas, style);
-    return style;
+    return toString(TERM_CANVAS);
 }
 
-
-
-void LineSpec::toStringBasic(const std::map<string, int> &lineTypeMapping,
-                             const std::map<string, int> &pointTypeMapping,
-                             std::string &style) const
+string LineSpec::getColor() const
 {
-    style = "set style line " + to_string(this->lineIndex);
-
-    //* linetype
-    try {
-        stringstream ss;
-        ss << setprecision(3) << lineTypeMapping.at(this->lineType);
-        style += " lt " + ss.str();
-    }
-    catch (const out_of_range &) {
-        throw invalid_argument("LineStyle must be \"-\", \"--\", \":\", \"-.\", or \"none\"");
-    }
-
-    //* linewidth
-    stringstream ssLineWidth;
-    ssLineWidth << setprecision(3) << this->lineWidth;
-    style += " lw " + ssLineWidth.str();
-
-    //* pointtype
-    try {
-        style += " pt " + to_string( (pointType.empty()) ? lineIndex : pointTypeMapping.at(pointType) );
-    }
-    catch (const out_of_range &) {
-        throw invalid_argument("Marker must be one of \"o+*.xsd^v><ph\" or \"none\"");
-    }
-
-    //* pointsize
-    stringstream ssPointSize;
-    ssPointSize << setprecision(3) << this->pointSize;
-    style += " ps " + ssPointSize.str();
-
-    //* color
-    string color = this->color;
-    if (color.size()==1) {
-        //* color shortcut
-        try {
-            style += " lc rgb '" + this->colorShortCutMapping.at(this->color[0]) + "'";
-        }
-        catch (const out_of_range &) {
-            throw out_of_range("Color shortcut must be one of \"ymcrgbwk\"");
-        }
-    }
-    else {
-
-        //* remove any white space
-        color.erase(remove_if(color.begin(), color.end(), ::isspace), color.end());
-
-        if (color[0]=='[' || color[0]=='(') {
-
-            bool isDecimal = (color[0]=='(') ? true : false;
-
-            //* Matlab color code or decimal code
-            color = color.substr(1, color.size());
-
-            //* count number of commas
-            int nComma = 0;
-            for (auto it=color.begin(); it!=color.end(); ++it) {
-                if (*it == ',') {
-                    nComma++;
-                }
-            }
-            if (nComma!=2) {
-                throw invalid_argument("Brackted color triples must contain exact two commas, \"[r,g,b]\" or \"(r,g,b)\"");
-            }
+    char color[maxColorTextLength];
+    return string(color, formatColor(color, this->record.color));
+}
 
-            //* Get rgb respective values
-            const int nRGB = 3;
-            vector<int>    rgbValue(nRGB);
-            vector<double> frgbValue(nRGB);
-            stringstream   ss(color);
-            string         str;
-            if (isDecimal) {
-                //* decimal color code
-                int index=0;
-                while (getline(ss, str, ',')) {
-                    try {
-                        rgbValue[index] = stod(str);  // may throw invalid_argument
-                    }
-                    catch (const invalid_argument &) {
-                        throw invalid_argument("Parenthesized color triples must be in integers within 0-255: " + str);
-                    }
-                    //* check range
-                    if (rgbValue[index]>255 || rgbValue[index]<0) {
-                        throw invalid_argument("Parenthesized color triples must be in integers within 0-255: " + str);
-                    }
-                    index++;
-                }
-            }
-            else {
-                //* Matlab color code
-                int index=0;
-                const double epsilon=0.001;  // small value to ensure 1->255
-                while (getline(ss, str, ',')) {
-                    try {
-                        frgbValue[index] = stod(str);  // may throw invalid_argument
-                    }
-                    catch (const invalid_argument &) {
-                        throw invalid_argument("Bracketed color triples must be in decimals within 0.0-1.0: " + str);
-                    }
-                    //* check range
-                    if (rgbValue[index]>1 || rgbValue[index]<0) {
-                        throw invalid_argument("Bracketed color triples must be in decimals within 0.0-1.0: " + str);
-                    }
-                    //* convert to [0,255] values
-                    rgbValue[index] = floor(frgbValue[index]*256-epsilon);
-                    index++;
-                    cout << rgbValue[index-1] << endl;
-                }
-            }
-            //* Convert xterm format to hex code
-            stringstream ssHexcode;
-            ssHexcode << std::hex << "#"
-                         << setw(2) << setfill('0') << rgbValue[0]
-                         << setw(2) << setfill('0') << rgbValue[1]
-                         << setw(2) << setfill('0') << rgbValue[2];
-            string hexcode = ssHexcode.str();
-
-            style += " lc rgb '" + hexcode + "'";
-        }
-        else {
-            //* color string is a color name or hex color code
-            style += " lc rgb '" + color + "'";
-        }
-    }
+double LineSpec::getLineWidth() const
+{
+    return this->record.lineWidth;
 }
 
+double LineSpec::getPointSize() const
+{
+    return this->record.pointSize;
+}
 
-unsigned LineSpec::lineCount = 0;
+LineType LineSpec::getLineType() const
+{
+    return this->record.lineType;
+}
 
-void LineSpec::resetLineCount()
+int LineSpec::getPointType(TerminalType tt) const
 {
-    LineSpec::lineCount = 0;
+    if (this->record.marker == MARKER_DEFAULT) {
+        return static_cast<int>(this->record.index);
+    }
+    return pointTypeTable[tt][this->record.marker];
 }
 
 bool LineSpec::isPointOnly() const
 {
-    return (this->lineType.compare("none")==0)? true : false;
+    return this->record.lineType == LINE_NONE;
 }
 
 unsigned LineSpec::getGridLineType(TerminalType tt)
 {
-    switch (tt) {
-    case TERM_AQUA:
-        return LineSpec::lineTypeMappingAqua.at(":");
-        break;
-    case TERM_WXT:
-    case TERM_SVG:
-    case TERM_CANVAS:
-    case TERM_CAIRO:
-        return LineSpec::lineTypeMappingOther.at(":");
-        break;
-    default:  // TERM_OTHER
-        return LineSpec::lineTypeMappingOther.at(":");
-    }
+    return lineTypeTable[tt][LINE_DOTTED];
 }
 
 
-//* Static member init
-const vector<string> LineSpec::defaultColor {
-    "#f00032",  // red
-    "#227500",  // green
-    "#1a3bea",  // blue
-    "#e700f0",  // magenta
-    "#00beb1",  // cyan
-    "#8b4513",  // brown
-    "#f0c000",  // yellow
-    "#808000",  // olive
-    "#505050",  // gray
-    "#6b00d2"   // purple
-};
-
-std::string LineSpec::gridColor = "#cccccc";
-
-const map<string, int> LineSpec::lineTypeMappingAqua {
-    {"-",    1},
-    {"--",   2},
-    {":",    4},
-    {"-.",   5},
-    {"none", 0}
-};
-
-const map<string, int> LineSpec::lineTypeMappingOther {
-    {"-",    1},
-    {"--",   2},
-    {":",    3},
-    {"-.",   4},
-    {"none", 0}
-};
-
-const map<string, int> LineSpec::pointTypeMappingAqua {
-    {"o", 5},
-    {"+", 1},
-    {"*", 3},
-    {".", 5},
-    {"x", 2},
-    {"s", 4},
-    {"square", 4},
-    {"d", 5},
-    {"diamond", 5},
-    {"^", 6},
-    {"v", 6},
-    {">", 6},
-    {"<", 6},
-    {"p", 5},
-    {"pentagram", 5},
-    {"h", 5},
-    {"hexagram", 5},
-    {"none", 0}
-};
-
-const map<string, int> LineSpec::pointTypeMappingCanvas {
-    {"o", 6},
-    {"+", 1},
-    {"*", 3},
-    {".", 7},
-    {"x", 2},
-    {"s", 4},
-    {"square", 4},
-    {"d", 5},
-    {"diamond", 5},
-    {"^", 8},
-    {"v", 9},
-    {">", 8},
-    {"<", 9},
-    {"p", 4},
-    {"pentagram", 4},
-    {"h", 8},
-    {"hexagram", 8},
-    {"none", 0}
-};
-
-const map<string, int> LineSpec::pointTypeMappingOther {
-    {"o", 6},
-    {"+", 1},
-    {"*", 3},
-    {".", 7},
-    {"x", 2},
-    {"s", 4},
-    {"square", 4},
-    {"d", 12},
-    {"diamond", 12},
-    {"^", 8},
-    {"v", 10},
-    {">", 9},
-    {"<", 11},
-    {"p", 5},
-    {"pentagram", 5},
-    {"h", 13},
-    {"hexagram", 13},
-    {"none", 0}
-};
-
-const map<char, string> LineSpec::colorShortCutMapping {
-    {'y', "yellow"},
-    {'m', "magenta"},
-    {'c', "cyan"},
-    {'r', "red"},
-    {'g', "green"},
-    {'b', "blue"},
-    {'w', "white"},
-    {'k', "black"}
-};
-
-
+const std::string LineSpec::gridColor = "#cccccc";
 
 
 }
@@ -70,6 +70,7 @@ int main()
 void example1(vector<double> &t, vector<double> &x) {
     eggp::Eggplot curvePlot;
 
+    // copies t and x; plot({DataView(t), DataView(x)}) copies nothing
     curvePlot.plot({t,x});
     curvePlot.exec();
 }
@@ -111,6 +112,9 @@ void example4(vector<double> &t, vector<double> &x1, vector<double> &x2 ) {
     // set export file name, default: "eggp-export"
     curvePlot.print("eggp-export-ex4");
 
+    // render all six outputs in one gnuplot process
+    curvePlot.session(true);
+
     curvePlot.plot({ t,x1, t,x2 });
     curvePlot.exec();
 }
@@ -203,17 +207,8 @@ void exampleMultiLine() {
 
     curvePlot.xlabel("time t (sec)");
     curvePlot.ylabel("f_i(t)\\n(voltage)");
-    curvePlot.plot({t,x1,
-                    t,x2,
-                    t,x3,
-                    t,x4,
-                    t,x5,
-                    t,x6,
-                    t,x7,
-                    t,x8,
-                    t,x9,
-                    t,x10,
-                    t,x11});
+    // All curves share t, which is then written only once
+    curvePlot.plot(t, {x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11});
 
     // Setup two properties for Line 3 in one statement
     curvePlot.linespec(3, {{Marker, "*"}, {LineStyle, "--"}});
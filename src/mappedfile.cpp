@@ -0,0 +1,139 @@
+#include "mappedfile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const string &filename, size_t capacity)
+    : filename(filename),
+      nCapacity(capacity),
+      address(nullptr),
+      buffer(capacity)
+{
+    this->address = this->buffer.empty() ? nullptr : &this->buffer[0];
+}
+
+MappedFile::~MappedFile()
+{
+}
+
+void MappedFile::close(size_t size)
+{
+    FILE *file = fopen(this->filename.c_str(), "wb");
+    if (file == nullptr) {
+        throw runtime_error("Cannot write " + this->filename + ": " + strerror(errno));
+    }
+    bool isOk = fwrite(this->address, 1, size, file) == size;
+    isOk = (fclose(file) == 0) && isOk;
+    this->buffer.clear();
+    this->address = nullptr;
+    if (!isOk) {
+        throw runtime_error("Cannot write " + this->filename);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const string &filename, size_t capacity)
+    : filename(filename),
+      nCapacity(capacity),
+      address(nullptr),
+      fd(-1)
+{
+    this->fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (this->fd < 0) {
+        throw runtime_error("Cannot write " + filename + ": " + strerror(errno));
+    }
+    if (capacity == 0) {
+        return;
+    }
+
+    //* Reserve the blocks up front: a full disk is reported here rather
+    //* than as SIGBUS while the mapping is written.
+    int error = 0;
+#ifdef __linux__
+    error = posix_fallocate(this->fd, 0, static_cast<off_t>(capacity));
+    if (error == EINVAL || error == EOPNOTSUPP) {
+        //* file system without preallocation
+        error = (ftruncate(this->fd, static_cast<off_t>(capacity)) == 0) ? 0 : errno;
+    }
+#else
+    error = (ftruncate(this->fd, static_cast<off_t>(capacity)) == 0) ? 0 : errno;
+#endif
+    if (error == 0) {
+        void *map = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+        if (map == MAP_FAILED) {
+            error = errno;
+        }
+        else {
+            this->address = static_cast<char*>(map);
+        }
+    }
+    if (error != 0) {
+        ::close(this->fd);
+        unlink(filename.c_str());
+        throw runtime_error("Cannot allocate " + to_string(static_cast<unsigned long long>(capacity))
+                            + " bytes for " + filename + ": " + strerror(error));
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (this->address != nullptr) {
+        munmap(this->address, this->nCapacity);
+    }
+    if (this->fd >= 0) {
+        ::close(this->fd);
+    }
+}
+
+void MappedFile::close(size_t size)
+{
+    //* munmap leaves the pages to the kernel's write-back; no msync needed
+    //* for other processes (gnuplot) to see them
+    if (this->address != nullptr) {
+        munmap(this->address, this->nCapacity);
+        this->address = nullptr;
+    }
+    int error = 0;
+    if (ftruncate(this->fd, static_cast<off_t>(size)) != 0) {
+        error = errno;
+    }
+    if (::close(this->fd) != 0 && error == 0) {
+        error = errno;
+    }
+    this->fd = -1;
+    if (error != 0) {
+        throw runtime_error("Cannot write " + this->filename + ": " + strerror(error));
+    }
+}
+
+#endif
+
+char *MappedFile::data()
+{
+    return this->address;
+}
+
+size_t MappedFile::capacity() const
+{
+    return this->nCapacity;
+}
+
+
+}
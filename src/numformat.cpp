@@ -0,0 +1,407 @@
+#include "numformat.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+//* "do-it-yourself" floating point number f * 2^e with a 64-bit significand
+struct DiyFp
+{
+    uint64_t f;
+    int      e;
+};
+
+DiyFp sub(const DiyFp &x, const DiyFp &y)
+{
+    return {x.f - y.f, x.e};
+}
+
+//* product rounded to the upper 64 bits
+DiyFp mul(const DiyFp &x, const DiyFp &y)
+{
+    const uint64_t mask = 0xFFFFFFFFu;
+    const uint64_t xLo = x.f & mask;
+    const uint64_t xHi = x.f >> 32;
+    const uint64_t yLo = y.f & mask;
+    const uint64_t yHi = y.f >> 32;
+
+    const uint64_t p0 = xLo*yLo;
+    const uint64_t p1 = xLo*yHi;
+    const uint64_t p2 = xHi*yLo;
+    const uint64_t p3 = xHi*yHi;
+
+    uint64_t middle = (p0 >> 32) + (p1 & mask) + (p2 & mask);
+    middle += uint64_t(1) << 31;
+    return {p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32), x.e + y.e + 64};
+}
+
+DiyFp normalize(DiyFp x)
+{
+    while ((x.f >> 63) == 0) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+//* a positive finite double and the bounds of the interval that rounds to it
+struct Boundaries
+{
+    DiyFp w;
+    DiyFp minus;
+    DiyFp plus;
+};
+
+Boundaries computeBoundaries(double value)
+{
+    const int      significandBits = 52;
+    const int      exponentBias    = 1075;  // 1023 + 52
+    const uint64_t hiddenBit       = uint64_t(1) << significandBits;
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint64_t biasedExponent = bits >> significandBits;
+    const uint64_t fraction       = bits & (hiddenBit-1);
+
+    const DiyFp v = (biasedExponent == 0)
+            ? DiyFp{fraction, 1-exponentBias}
+            : DiyFp{fraction + hiddenBit, static_cast<int>(biasedExponent) - exponentBias};
+
+    //* at a power of two the lower neighbor is twice as close
+    const bool isLowerCloser = fraction == 0 && biasedExponent > 1;
+    const DiyFp plus  = {2*v.f + 1, v.e - 1};
+    const DiyFp minus = isLowerCloser ? DiyFp{4*v.f - 1, v.e - 2} : DiyFp{2*v.f - 1, v.e - 1};
+
+    Boundaries result;
+    result.plus  = normalize(plus);
+    result.minus = {minus.f << (minus.e - result.plus.e), result.plus.e};
+    result.w     = normalize(v);
+    return result;
+}
+
+struct CachedPower
+{
+    uint64_t f;
+    int      e;
+    int      k;
+};
+
+//* 10^k for k = -348, -340, ..., 340, normalized and rounded to 64 bits
+const CachedPower cachedPowers[] = {
+    {0xFA8FD5A0081C0288, -1220, -348},
+    {0xBAAEE17FA23EBF76, -1193, -340},
+    {0x8B16FB203055AC76, -1166, -332},
+    {0xCF42894A5DCE35EA, -1140, -324},
+    {0x9A6BB0AA55653B2D, -1113, -316},
+    {0xE61ACF033D1A45DF, -1087, -308},
+    {0xAB70FE17C79AC6CA, -1060, -300},
+    {0xFF77B1FCBEBCDC4F, -1034, -292},
+    {0xBE5691EF416BD60C, -1007, -284},
+    {0x8DD01FAD907FFC3C,  -980, -276},
+    {0xD3515C2831559A83,  -954, -268},
+    {0x9D71AC8FADA6C9B5,  -927, -260},
+    {0xEA9C227723EE8BCB,  -901, -252},
+    {0xAECC49914078536D,  -874, -244},
+    {0x823C12795DB6CE57,  -847, -236},
+    {0xC21094364DFB5637,  -821, -228},
+    {0x9096EA6F3848984F,  -794, -220},
+    {0xD77485CB25823AC7,  -768, -212},
+    {0xA086CFCD97BF97F4,  -741, -204},
+    {0xEF340A98172AACE5,  -715, -196},
+    {0xB23867FB2A35B28E,  -688, -188},
+    {0x84C8D4DFD2C63F3B,  -661, -180},
+    {0xC5DD44271AD3CDBA,  -635, -172},
+    {0x936B9FCEBB25C996,  -608, -164},
+    {0xDBAC6C247D62A584,  -582, -156},
+    {0xA3AB66580D5FDAF6,  -555, -148},
+    {0xF3E2F893DEC3F126,  -529, -140},
+    {0xB5B5ADA8AAFF80B8,  -502, -132},
+    {0x87625F056C7C4A8B,  -475, -124},
+    {0xC9BCFF6034C13053,  -449, -116},
+    {0x964E858C91BA2655,  -422, -108},
+    {0xDFF9772470297EBD,  -396, -100},
+    {0xA6DFBD9FB8E5B88F,  -369,  -92},
+    {0xF8A95FCF88747D94,  -343,  -84},
+    {0xB94470938FA89BCF,  -316,  -76},
+    {0x8A08F0F8BF0F156B,  -289,  -68},
+    {0xCDB02555653131B6,  -263,  -60},
+    {0x993FE2C6D07B7FAC,  -236,  -52},
+    {0xE45C10C42A2B3B06,  -210,  -44},
+    {0xAA242499697392D3,  -183,  -36},
+    {0xFD87B5F28300CA0E,  -157,  -28},
+    {0xBCE5086492111AEB,  -130,  -20},
+    {0x8CBCCC096F5088CC,  -103,  -12},
+    {0xD1B71758E219652C,   -77,   -4},
+    {0x9C40000000000000,   -50,    4},
+    {0xE8D4A51000000000,   -24,   12},
+    {0xAD78EBC5AC620000,     3,   20},
+    {0x813F3978F8940984,    30,   28},
+    {0xC097CE7BC90715B3,    56,   36},
+    {0x8F7E32CE7BEA5C70,    83,   44},
+    {0xD5D238A4ABE98068,   109,   52},
+    {0x9F4F2726179A2245,   136,   60},
+    {0xED63A231D4C4FB27,   162,   68},
+    {0xB0DE65388CC8ADA8,   189,   76},
+    {0x83C7088E1AAB65DB,   216,   84},
+    {0xC45D1DF942711D9A,   242,   92},
+    {0x924D692CA61BE758,   269,  100},
+    {0xDA01EE641A708DEA,   295,  108},
+    {0xA26DA3999AEF774A,   322,  116},
+    {0xF209787BB47D6B85,   348,  124},
+    {0xB454E4A179DD1877,   375,  132},
+    {0x865B86925B9BC5C2,   402,  140},
+    {0xC83553C5C8965D3D,   428,  148},
+    {0x952AB45CFA97A0B3,   455,  156},
+    {0xDE469FBD99A05FE3,   481,  164},
+    {0xA59BC234DB398C25,   508,  172},
+    {0xF6C69A72A3989F5C,   534,  180},
+    {0xB7DCBF5354E9BECE,   561,  188},
+    {0x88FCF317F22241E2,   588,  196},
+    {0xCC20CE9BD35C78A5,   614,  204},
+    {0x98165AF37B2153DF,   641,  212},
+    {0xE2A0B5DC971F303A,   667,  220},
+    {0xA8D9D1535CE3B396,   694,  228},
+    {0xFB9B7CD9A4A7443C,   720,  236},
+    {0xBB764C4CA7A44410,   747,  244},
+    {0x8BAB8EEFB6409C1A,   774,  252},
+    {0xD01FEF10A657842C,   800,  260},
+    {0x9B10A4E5E9913129,   827,  268},
+    {0xE7109BFBA19C0C9D,   853,  276},
+    {0xAC2820D9623BF429,   880,  284},
+    {0x80444B5E7AA7CF85,   907,  292},
+    {0xBF21E44003ACDD2D,   933,  300},
+    {0x8E679C2F5E44FF8F,   960,  308},
+    {0xD433179D9C8CB841,   986,  316},
+    {0x9E19DB92B4E31BA9,  1013,  324},
+    {0xEB96BF6EBADF77D9,  1039,  332},
+    {0xAF87023B9BF0EE6B,  1066,  340},
+};
+
+const int cachedPowersMinExponent = -348;
+const int cachedPowersStep        = 8;
+
+//* target exponent range of the scaled significand
+const int alpha = -60;
+const int gamma = -32;
+
+//* a cached power c with alpha <= c.e + e + 64 <= gamma
+CachedPower cachedPowerFor(int e)
+{
+    //* k = ceil((alpha - e - 1) * log10(2)), 78913/2^18 being log10(2)
+    const int f = alpha - e - 1;
+    const int k = (f*78913)/(1 << 18) + static_cast<int>(f > 0);
+    const int index = (-cachedPowersMinExponent + k + (cachedPowersStep-1))/cachedPowersStep;
+    return cachedPowers[index];
+}
+
+//* number of decimal digits of n and the largest power of ten <= n
+int largestPow10(uint32_t n, uint32_t &pow10)
+{
+    const uint32_t powers[] = {
+        1000000000u, 100000000u, 10000000u, 1000000u, 100000u, 10000u, 1000u, 100u, 10u
+    };
+    for (int i=0; i<9; ++i) {
+        if (n >= powers[i]) {
+            pow10 = powers[i];
+            return 10-i;
+        }
+    }
+    pow10 = 1;
+    return 1;
+}
+
+//* moves the last digit towards w while staying inside the interval
+void roundWeed(char *buffer, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t tenK)
+{
+    while (rest < dist && delta-rest >= tenK
+           && (rest+tenK < dist || dist-rest > rest+tenK-dist)) {
+        buffer[length-1]--;
+        rest += tenK;
+    }
+}
+
+void generateDigits(char *buffer, int &length, int &decimalExponent,
+                    DiyFp minus, DiyFp w, DiyFp plus)
+{
+    uint64_t delta = sub(plus, minus).f;
+    uint64_t dist  = sub(plus, w).f;
+
+    //* split plus into integral part p1 and fractional part p2
+    const DiyFp one = {uint64_t(1) << -plus.e, plus.e};
+    uint32_t p1 = static_cast<uint32_t>(plus.f >> -one.e);
+    uint64_t p2 = plus.f & (one.f-1);
+
+    uint32_t pow10;
+    int n = largestPow10(p1, pow10);
+    while (n > 0) {
+        buffer[length++] = static_cast<char>('0' + p1/pow10);
+        p1 %= pow10;
+        n--;
+
+        uint64_t rest = (uint64_t(p1) << -one.e) + p2;
+        if (rest <= delta) {
+            decimalExponent += n;
+            roundWeed(buffer, length, dist, delta, rest, uint64_t(pow10) << -one.e);
+            return;
+        }
+        pow10 /= 10;
+    }
+
+    int m = 0;
+    while (true) {
+        p2 *= 10;
+        buffer[length++] = static_cast<char>('0' + (p2 >> -one.e));
+        p2 &= one.f-1;
+        m++;
+        delta *= 10;
+        dist  *= 10;
+        if (p2 <= delta) {
+            break;
+        }
+    }
+    decimalExponent -= m;
+    roundWeed(buffer, length, dist, delta, p2, one.f);
+}
+
+//* shortest digits of a positive finite value: value = digits * 10^decimalExponent
+void grisu2(char *buffer, int &length, int &decimalExponent, double value)
+{
+    const Boundaries b = computeBoundaries(value);
+    const CachedPower cached = cachedPowerFor(b.plus.e);
+    const DiyFp c = {cached.f, cached.e};
+
+    const DiyFp w     = mul(b.w, c);
+    const DiyFp minus = mul(b.minus, c);
+    const DiyFp plus  = mul(b.plus, c);
+
+    //* shrink the interval by one unit to absorb the rounding of mul()
+    length = 0;
+    decimalExponent = -cached.k;
+    generateDigits(buffer, length, decimalExponent,
+                   DiyFp{minus.f+1, minus.e}, w, DiyFp{plus.f-1, plus.e});
+}
+
+//* rounds half up to at most nDigit digits and drops trailing zeros
+void roundDigits(char *buffer, int &length, int &decimalExponent, int nDigit)
+{
+    if (length > nDigit) {
+        bool isUp = buffer[nDigit] >= '5';
+        decimalExponent += length-nDigit;
+        length = nDigit;
+        if (isUp) {
+            int i = length-1;
+            while (i >= 0 && buffer[i] == '9') {
+                buffer[i--] = '0';
+            }
+            if (i >= 0) {
+                buffer[i]++;
+            }
+            else {
+                //* all nines: 999 -> 100
+                buffer[0] = '1';
+                decimalExponent++;
+            }
+        }
+    }
+    while (length > 1 && buffer[length-1] == '0') {
+        length--;
+        decimalExponent++;
+    }
+}
+
+size_t writeExponent(char *out, int exponent)
+{
+    char *p = out;
+    *p++ = 'e';
+    *p++ = (exponent < 0) ? '-' : '+';
+    unsigned e = static_cast<unsigned>(exponent < 0 ? -exponent : exponent);
+    if (e >= 100) {
+        *p++ = static_cast<char>('0' + e/100);
+        e %= 100;
+    }
+    *p++ = static_cast<char>('0' + e/10);
+    *p++ = static_cast<char>('0' + e%10);
+    return p-out;
+}
+
+}
+
+
+size_t formatNumber(char *out, double value, unsigned digits)
+{
+    if (std::isnan(value)) {
+        memcpy(out, "nan", 3);
+        return 3;
+    }
+    char *p = out;
+    if (std::signbit(value)) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (std::isinf(value)) {
+        memcpy(p, "inf", 3);
+        return p-out+3;
+    }
+    if (value == 0) {
+        *p++ = '0';
+        return p-out;
+    }
+
+    char buffer[32];
+    int  length;
+    int  decimalExponent;
+    grisu2(buffer, length, decimalExponent, value);
+    int minFixed = -5;
+    int maxFixed = 15;
+    if (digits > 0 && digits < maxPrecision) {
+        roundDigits(buffer, length, decimalExponent, static_cast<int>(digits));
+        //* switch notation where printf's %g does
+        minFixed = -4;
+        maxFixed = static_cast<int>(digits) - 1;
+    }
+
+    //* value = 0.d1d2...dn * 10^point
+    const int point    = length + decimalExponent;
+    const int exponent = point - 1;
+    if (exponent < minFixed || exponent > maxFixed) {
+        *p++ = buffer[0];
+        if (length > 1) {
+            *p++ = '.';
+            memcpy(p, buffer+1, length-1);
+            p += length-1;
+        }
+        p += writeExponent(p, exponent);
+    }
+    else if (point <= 0) {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -point);
+        p += -point;
+        memcpy(p, buffer, length);
+        p += length;
+    }
+    else if (point >= length) {
+        memcpy(p, buffer, length);
+        p += length;
+        memset(p, '0', point-length);
+        p += point-length;
+    }
+    else {
+        memcpy(p, buffer, point);
+        p += point;
+        *p++ = '.';
+        memcpy(p, buffer+point, length-point);
+        p += length-point;
+    }
+    return p-out;
+}
+
+
+}
@@ -0,0 +1,67 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace eggp{
+
+
+unsigned defaultThreadCount()
+{
+    unsigned n = thread::hardware_concurrency();
+    return (n==0) ? 1 : n;
+}
+
+void parallelFor(size_t n, unsigned nThread, const function<void(size_t)> &task)
+{
+    if (n==0) {
+        return;
+    }
+    if (nThread==0) {
+        nThread = defaultThreadCount();
+    }
+    nThread = static_cast<unsigned>(min<size_t>(nThread, n));
+
+    //* work is handed out one index at a time so uneven tasks balance out
+    atomic<size_t> next(0);
+    exception_ptr  error;
+    mutex          errorMutex;
+
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next++) < n) {
+            try {
+                task(i);
+            }
+            catch (...) {
+                lock_guard<mutex> lock(errorMutex);
+                if (!error) {
+                    error = current_exception();
+                }
+            }
+        }
+    };
+
+    vector<thread> threads;
+    threads.reserve(nThread-1);
+    for (unsigned i=1; i<nThread; ++i) {
+        threads.push_back(thread(worker));
+    }
+    worker();
+    for (auto it=threads.begin(); it!=threads.end(); ++it) {
+        it->join();
+    }
+
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+
+}
@@ -0,0 +1,79 @@
+#include "plotbatch.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#include "parallel.h"
+#include "session.h"
+
+using namespace std;
+
+namespace eggp{
+
+
+PlotBatch::PlotBatch(unsigned nProcess)
+    : nProcess((nProcess==0) ? 1 : nProcess),
+      scripts()
+{
+}
+
+void PlotBatch::add(const Eggplot &figure)
+{
+    Eggplot copy(figure);
+    string script = copy.batchScript();
+    if (!script.empty()) {
+        this->scripts.push_back(script);
+    }
+}
+
+size_t PlotBatch::size() const
+{
+    return this->scripts.size();
+}
+
+void PlotBatch::exec(bool run_gnuplot)
+{
+    size_t nGroup = min<size_t>(this->nProcess, this->scripts.size());
+    vector<string> errors(nGroup);
+
+    //* consecutive figures go to the same process
+    parallelFor(nGroup, nGroup, [&](size_t k) {
+        size_t begin = k*this->scripts.size()/nGroup;
+        size_t end   = (k+1)*this->scripts.size()/nGroup;
+
+        string script = "# Gnuplot batch script\n";
+        for (size_t i=begin; i<end; ++i) {
+            script += this->scripts[i];
+        }
+
+        if (!run_gnuplot) {
+            string filename = (nGroup==1) ? "eggp-batch.gp"
+                                          : "eggp-batch-" + to_string(k+1) + ".gp";
+            ofstream fout(filename.c_str(), ios::out | ios::binary);
+            fout << script;
+            return;
+        }
+
+        try {
+            GnuplotSession session;
+            session.run(script);
+        }
+        catch (const exception &e) {
+            errors[k] = "figures " + to_string(begin+1) + "-" + to_string(end) + ": " + e.what();
+        }
+    });
+    this->scripts.clear();
+
+    string message;
+    for (auto it=errors.begin(); it!=errors.end(); ++it) {
+        if (!it->empty()) {
+            message += (message.empty() ? "" : "; ") + *it;
+        }
+    }
+    if (!message.empty()) {
+        throw runtime_error("gnuplot failed: " + message);
+    }
+}
+
+
+}
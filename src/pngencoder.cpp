@@ -0,0 +1,299 @@
+#include "pngencoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+struct CrcTable
+{
+    uint32_t entry[256];
+
+    CrcTable()
+    {
+        for (uint32_t i=0; i<256; ++i) {
+            uint32_t c = i;
+            for (int k=0; k<8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c>>1) : c>>1;
+            }
+            this->entry[i] = c;
+        }
+    }
+};
+
+uint32_t crc32(const unsigned char *data, size_t n, uint32_t crc=0)
+{
+    //* built once, even with concurrent encoders
+    static const CrcTable table;
+
+    crc = ~crc;
+    for (size_t i=0; i<n; ++i) {
+        crc = table.entry[(crc ^ data[i]) & 0xff] ^ (crc>>8);
+    }
+    return ~crc;
+}
+
+uint32_t adler32(const unsigned char *data, size_t n)
+{
+    const uint32_t modulus = 65521;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (n > 0) {
+        //* largest block before b can overflow 32 bits
+        size_t block = (n < 5552) ? n : 5552;
+        n -= block;
+        while (block-- > 0) {
+            a += *data++;
+            b += a;
+        }
+        a %= modulus;
+        b %= modulus;
+    }
+    return (b<<16) | a;
+}
+
+void appendBigEndian(string &out, uint32_t value)
+{
+    out += static_cast<char>(value>>24);
+    out += static_cast<char>(value>>16);
+    out += static_cast<char>(value>>8);
+    out += static_cast<char>(value);
+}
+
+void writeChunk(ostream &out, const char *type, const string &data)
+{
+    string chunk;
+    appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.append(type, 4);
+    chunk += data;
+    const unsigned char *crcBegin = reinterpret_cast<const unsigned char*>(chunk.data()) + 4;
+    appendBigEndian(chunk, crc32(crcBegin, chunk.size()-4));
+    out.write(chunk.data(), chunk.size());
+}
+
+//* deflate bit stream: least significant bit first, Huffman codes reversed
+class BitWriter
+{
+public:
+    explicit BitWriter(string &out) : out(out), bits(0), nBit(0) {}
+
+    void put(uint32_t value, unsigned n)
+    {
+        this->bits |= static_cast<uint64_t>(value) << this->nBit;
+        this->nBit += n;
+        while (this->nBit >= 8) {
+            this->out += static_cast<char>(this->bits & 0xff);
+            this->bits >>= 8;
+            this->nBit -= 8;
+        }
+    }
+
+    void putCode(uint32_t code, unsigned n)
+    {
+        uint32_t reversed = 0;
+        for (unsigned i=0; i<n; ++i) {
+            reversed = (reversed<<1) | ((code>>i) & 1);
+        }
+        put(reversed, n);
+    }
+
+    void flush()
+    {
+        if (this->nBit > 0) {
+            put(0, 8-this->nBit);
+        }
+    }
+
+private:
+    string  &out;
+    uint64_t bits;
+    unsigned nBit;
+};
+
+//* fixed Huffman code of literal/length symbols 0-287, RFC 1951 3.2.6
+void putSymbol(BitWriter &writer, unsigned symbol)
+{
+    if (symbol < 144) {
+        writer.putCode(0x30+symbol, 8);
+    }
+    else if (symbol < 256) {
+        writer.putCode(0x190+symbol-144, 9);
+    }
+    else if (symbol < 280) {
+        writer.putCode(symbol-256, 7);
+    }
+    else {
+        writer.putCode(0xc0+symbol-280, 8);
+    }
+}
+
+const unsigned lengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const unsigned lengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const unsigned distanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+const unsigned distanceExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+void putMatch(BitWriter &writer, unsigned length, unsigned distance)
+{
+    unsigned i = 28;
+    while (lengthBase[i] > length) {
+        --i;
+    }
+    putSymbol(writer, 257+i);
+    writer.put(length-lengthBase[i], lengthExtra[i]);
+
+    unsigned j = 29;
+    while (distanceBase[j] > distance) {
+        --j;
+    }
+    writer.putCode(j, 5);
+    writer.put(distance-distanceBase[j], distanceExtra[j]);
+}
+
+string deflate(const vector<unsigned char> &data)
+{
+    const unsigned hashBits  = 15;
+    const size_t   window    = 32768;
+    const unsigned minMatch  = 3;
+    const unsigned maxMatch  = 258;
+
+    string out;
+    out.reserve(data.size()/8 + 64);
+    out += '\x78';  // deflate, 32K window
+    out += '\x01';  // no dictionary, fastest level; header is a multiple of 31
+
+    BitWriter writer(out);
+    writer.put(1, 1);  // final block
+    writer.put(1, 2);  // fixed Huffman codes
+
+    //* most recent position of each 3-byte prefix
+    vector<int64_t> head(size_t(1)<<hashBits, -1);
+    const size_t n = data.size();
+    size_t i = 0;
+    while (i < n) {
+        unsigned bestLength = 0;
+        size_t   bestDistance = 0;
+        if (i+minMatch <= n) {
+            uint32_t hash = ((data[i]<<16) | (data[i+1]<<8) | data[i+2]) * 2654435761u >> (32-hashBits);
+            int64_t candidate = head[hash];
+            head[hash] = static_cast<int64_t>(i);
+            if (candidate >= 0 && i-candidate <= window) {
+                size_t limit = (n-i < maxMatch) ? n-i : maxMatch;
+                unsigned length = 0;
+                while (length < limit && data[candidate+length] == data[i+length]) {
+                    ++length;
+                }
+                if (length >= minMatch) {
+                    bestLength   = length;
+                    bestDistance = i-candidate;
+                }
+            }
+        }
+
+        if (bestLength > 0) {
+            putMatch(writer, bestLength, static_cast<unsigned>(bestDistance));
+            i += bestLength;
+        }
+        else {
+            putSymbol(writer, data[i]);
+            ++i;
+        }
+    }
+    putSymbol(writer, 256);  // end of block
+    writer.flush();
+
+    appendBigEndian(out, adler32(data.data(), n));
+    return out;
+}
+
+}
+
+
+void encodePng(ostream &out, const unsigned char *rgba, unsigned width, unsigned height)
+{
+    const size_t nPixel = static_cast<size_t>(width)*height;
+
+    //* plots are opaque as a rule: then the alpha channel is left out
+    bool isOpaque = true;
+    for (size_t i=0; i<nPixel && isOpaque; ++i) {
+        isOpaque = rgba[4*i+3] == 255;
+    }
+    const unsigned bytesPerPixel = isOpaque ? 3 : 4;
+    const size_t   stride        = static_cast<size_t>(width)*bytesPerPixel;
+
+    vector<unsigned char> line(stride);
+    vector<unsigned char> prev(stride, 0);
+
+    //* filter type byte followed by the filtered row
+    vector<unsigned char> filtered((stride+1)*height);
+    vector<unsigned char> candidate[3];
+    for (int k=0; k<3; ++k) {
+        candidate[k].resize(stride);
+    }
+    for (unsigned row=0; row<height; ++row) {
+        const unsigned char *source = rgba + static_cast<size_t>(row)*width*4;
+        for (unsigned col=0; col<width; ++col) {
+            for (unsigned c=0; c<bytesPerPixel; ++c) {
+                line[col*bytesPerPixel+c] = source[4*col+c];
+            }
+        }
+
+        //* None, Sub and Up; the smallest sum of signed residuals wins
+        unsigned long cost[3] = {0, 0, 0};
+        for (size_t i=0; i<stride; ++i) {
+            unsigned char left = (i >= bytesPerPixel) ? line[i-bytesPerPixel] : 0;
+            candidate[0][i] = line[i];
+            candidate[1][i] = static_cast<unsigned char>(line[i]-left);
+            candidate[2][i] = static_cast<unsigned char>(line[i]-prev[i]);
+            for (int k=0; k<3; ++k) {
+                cost[k] += abs(static_cast<signed char>(candidate[k][i]));
+            }
+        }
+        int best = 0;
+        for (int k=1; k<3; ++k) {
+            if (cost[k] < cost[best]) {
+                best = k;
+            }
+        }
+        unsigned char *dest = &filtered[row*(stride+1)];
+        dest[0] = static_cast<unsigned char>(best);
+        copy(candidate[best].begin(), candidate[best].end(), dest+1);
+        line.swap(prev);
+    }
+
+    string header;
+    appendBigEndian(header, width);
+    appendBigEndian(header, height);
+    header += '\x08';                   // bit depth
+    header += isOpaque ? '\x02' : '\x06';  // truecolor, with alpha unless opaque
+    header += '\x00';                   // deflate
+    header += '\x00';                   // adaptive filtering
+    header += '\x00';                   // no interlace
+
+    out.write("\x89PNG\r\n\x1a\n", 8);
+    writeChunk(out, "IHDR", header);
+    writeChunk(out, "IDAT", deflate(filtered));
+    writeChunk(out, "IEND", "");
+}
+
+
+}
@@ -0,0 +1,175 @@
+#include "pngwriter.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "color.h"
+#include "pngencoder.h"
+#include "raster.h"
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+const uint32_t black = 0xff000000u;
+
+uint32_t toColor(const string &color)
+{
+    uint32_t argb;
+    return parseColor(color, argb) ? argb : black;
+}
+
+vector<double> dashPattern(LineType lineType, double lineWidth)
+{
+    double w = (lineWidth < 1) ? 1 : lineWidth;
+    switch (lineType) {
+    case LINE_DASHED:
+        return {8*w, 4*w};
+    case LINE_DOTTED:
+        return {2*w, 4*w};
+    case LINE_DASHDOT:
+        return {8*w, 4*w, 2*w, 4*w};
+    default:
+        return vector<double>();
+    }
+}
+
+}
+
+
+void writePng(ostream &out, const FigureSpec &figure, unsigned width, unsigned height)
+{
+    const Frame frame(figure, width, height);
+    const vector<double> xTicks = frame.x.ticks();
+    const vector<double> yTicks = frame.y.ticks();
+
+    Raster raster(width, height);
+
+    //* grid
+    if (figure.isGridded) {
+        const uint32_t gridColor = toColor(LineSpec::gridColor);
+        const vector<double> dash = {2, 4};
+        for (auto it=xTicks.begin(); it!=xTicks.end(); ++it) {
+            double px[2] = {frame.toPixelX(*it), frame.toPixelX(*it)};
+            double py[2] = {frame.top, frame.bottom};
+            raster.strokePolyline(px, py, 2, 1, gridColor, dash);
+        }
+        for (auto it=yTicks.begin(); it!=yTicks.end(); ++it) {
+            double px[2] = {frame.left, frame.right};
+            double py[2] = {frame.toPixelY(*it), frame.toPixelY(*it)};
+            raster.strokePolyline(px, py, 2, 1, gridColor, dash);
+        }
+    }
+
+    //* curves: a polyline per run of finite points, then the markers
+    raster.clip(frame.left, frame.top, frame.right, frame.bottom);
+    vector<double> px;
+    vector<double> py;
+    for (size_t iCurve=0; iCurve<figure.curves.size(); ++iCurve) {
+        const DataView &x    = figure.curves[iCurve].first;
+        const DataView &y    = figure.curves[iCurve].second;
+        const LineSpec &spec = figure.lineSpec[iCurve];
+        const uint32_t color = spec.style().color;
+        const double   lineWidth = spec.getLineWidth();
+
+        px.resize(x.size());
+        py.resize(x.size());
+        const double scaleX = (frame.right-frame.left)/(frame.x.hi-frame.x.lo);
+        const double scaleY = (frame.bottom-frame.top)/(frame.y.hi-frame.y.lo);
+        for (size_t i=0; i<x.size(); ++i) {
+            px[i] = frame.left   + (x[i]-frame.x.lo)*scaleX;
+            py[i] = frame.bottom - (y[i]-frame.y.lo)*scaleY;
+        }
+
+        if (iCurve < figure.nBand) {
+            const uint32_t fill = bandColor(figure.lineSpec[figure.nBand].style().color);
+            raster.fillPolygon(px.data(), py.data(), px.size(), fill);
+            continue;
+        }
+
+        if (!spec.isPointOnly() && lineWidth > 0) {
+            const vector<double> dash = dashPattern(spec.getLineType(), lineWidth);
+            size_t begin = 0;
+            for (size_t i=0; i<=px.size(); ++i) {
+                if (i==px.size() || !std::isfinite(px[i]) || !std::isfinite(py[i])) {
+                    raster.strokePolyline(px.data()+begin, py.data()+begin, i-begin, lineWidth, color, dash);
+                    begin = i+1;
+                }
+            }
+        }
+
+        int pointType = spec.getPointType(TERM_CAIRO);
+        if (pointType > 0 && spec.getPointSize() > 0 && !px.empty()) {
+            raster.drawMarkers(px.data(), py.data(), px.size(), pointType, 4*spec.getPointSize(), color);
+        }
+    }
+    raster.unclip();
+
+    //* border, ticks (mirrored) and tick labels
+    const double tickLength = 6;
+    raster.fillRect(frame.left-0.5,  frame.top-0.5,    frame.right+0.5, frame.top+0.5,    black);
+    raster.fillRect(frame.left-0.5,  frame.bottom-0.5, frame.right+0.5, frame.bottom+0.5, black);
+    raster.fillRect(frame.left-0.5,  frame.top-0.5,    frame.left+0.5,  frame.bottom+0.5, black);
+    raster.fillRect(frame.right-0.5, frame.top-0.5,    frame.right+0.5, frame.bottom+0.5, black);
+    for (auto it=xTicks.begin(); it!=xTicks.end(); ++it) {
+        double x = frame.toPixelX(*it);
+        raster.fillRect(x-0.5, frame.bottom-tickLength, x+0.5, frame.bottom, black);
+        raster.fillRect(x-0.5, frame.top, x+0.5, frame.top+tickLength, black);
+        raster.drawText(x, frame.bottom+12, frame.x.tickLabel(*it), black, ALIGN_CENTER);
+    }
+    for (auto it=yTicks.begin(); it!=yTicks.end(); ++it) {
+        double y = frame.toPixelY(*it);
+        raster.fillRect(frame.left, y-0.5, frame.left+tickLength, y+0.5, black);
+        raster.fillRect(frame.right-tickLength, y-0.5, frame.right, y+0.5, black);
+        raster.drawText(frame.left-6, y, frame.y.tickLabel(*it), black, ALIGN_RIGHT);
+    }
+
+    //* title and axis labels
+    double centerX = (frame.left+frame.right)/2;
+    double centerY = (frame.top+frame.bottom)/2;
+    if (!figure.title.empty()) {
+        raster.drawText(centerX, frame.top-16, figure.title, black, ALIGN_CENTER);
+    }
+    if (!figure.xlabel.empty()) {
+        raster.drawText(centerX, frame.bottom+34, figure.xlabel, black, ALIGN_CENTER);
+    }
+    if (!figure.ylabel.empty()) {
+        raster.drawText(frame.left-58, centerY, figure.ylabel, black, ALIGN_CENTER, true);
+    }
+
+    //* legend, top right inside the plot as gnuplot's default key
+    for (size_t iCurve=0; iCurve<figure.curves.size() && iCurve<figure.legend.size(); ++iCurve) {
+        const LineSpec &spec = figure.lineSpec[iCurve];
+        const uint32_t color = spec.style().color;
+        double y      = frame.top + 14 + 18*iCurve;
+        double sample = frame.right - 50;
+
+        raster.drawText(sample-8, y, figure.legend[iCurve], black, ALIGN_RIGHT);
+        if (iCurve < figure.nBand) {
+            raster.fillRect(sample, y-5, sample+40, y+5,
+                            bandColor(figure.lineSpec[figure.nBand].style().color));
+            continue;
+        }
+        if (!spec.isPointOnly()) {
+            double lx[2] = {sample, sample+40};
+            double ly[2] = {y, y};
+            raster.strokePolyline(lx, ly, 2, spec.getLineWidth(), color,
+                                  dashPattern(spec.getLineType(), spec.getLineWidth()));
+        }
+        int pointType = spec.getPointType(TERM_CAIRO);
+        if (pointType > 0 && spec.getPointSize() > 0) {
+            double mx = sample+20;
+            raster.drawMarkers(&mx, &y, 1, pointType, 4*spec.getPointSize(), color);
+        }
+    }
+
+    const vector<unsigned char> &pixels = raster.pixels();
+    encodePng(out, pixels.data(), width, height);
+}
+
+
+}
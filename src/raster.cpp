@@ -0,0 +1,648 @@
+#include "raster.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+//* 5x7 glyphs of printable ASCII from ' ', one byte per row, bit 4 leftmost
+const unsigned char font[95][7] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // ' '
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04},  // '!'
+    {0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00},  // '"'
+    {0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a},  // '#'
+    {0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04},  // '$'
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},  // '%'
+    {0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d},  // '&'
+    {0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00},  // '\''
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02},  // '('
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08},  // ')'
+    {0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00},  // '*'
+    {0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00},  // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08},  // ','
+    {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00},  // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c},  // '.'
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00},  // '/'
+    {0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e},  // '0'
+    {0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e},  // '1'
+    {0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f},  // '2'
+    {0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e},  // '3'
+    {0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02},  // '4'
+    {0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e},  // '5'
+    {0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e},  // '6'
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},  // '7'
+    {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e},  // '8'
+    {0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c},  // '9'
+    {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00},  // ':'
+    {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08},  // ';'
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02},  // '<'
+    {0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00},  // '='
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08},  // '>'
+    {0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04},  // '?'
+    {0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e},  // '@'
+    {0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},  // 'A'
+    {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e},  // 'B'
+    {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e},  // 'C'
+    {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c},  // 'D'
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f},  // 'E'
+    {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10},  // 'F'
+    {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f},  // 'G'
+    {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},  // 'H'
+    {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},  // 'I'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c},  // 'J'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},  // 'K'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f},  // 'L'
+    {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11},  // 'M'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},  // 'N'
+    {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},  // 'O'
+    {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10},  // 'P'
+    {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d},  // 'Q'
+    {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11},  // 'R'
+    {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e},  // 'S'
+    {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},  // 'T'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},  // 'U'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04},  // 'V'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a},  // 'W'
+    {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11},  // 'X'
+    {0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04},  // 'Y'
+    {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f},  // 'Z'
+    {0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e},  // '['
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00},  // '\\'
+    {0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e},  // ']'
+    {0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00},  // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f},  // '_'
+    {0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00},  // '`'
+    {0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f},  // 'a'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e},  // 'b'
+    {0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e},  // 'c'
+    {0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f},  // 'd'
+    {0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e},  // 'e'
+    {0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08},  // 'f'
+    {0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x0e},  // 'g'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11},  // 'h'
+    {0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e},  // 'i'
+    {0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0c},  // 'j'
+    {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12},  // 'k'
+    {0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},  // 'l'
+    {0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11},  // 'm'
+    {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11},  // 'n'
+    {0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e},  // 'o'
+    {0x00, 0x00, 0x1e, 0x11, 0x1e, 0x10, 0x10},  // 'p'
+    {0x00, 0x00, 0x0d, 0x13, 0x0f, 0x01, 0x01},  // 'q'
+    {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10},  // 'r'
+    {0x00, 0x00, 0x0e, 0x10, 0x0e, 0x01, 0x1e},  // 's'
+    {0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06},  // 't'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d},  // 'u'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04},  // 'v'
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a},  // 'w'
+    {0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11},  // 'x'
+    {0x00, 0x00, 0x11, 0x11, 0x0f, 0x01, 0x0e},  // 'y'
+    {0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f},  // 'z'
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02},  // '{'
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},  // '|'
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08},  // '}'
+    {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00},  // '~'
+};
+
+const int glyphWidth   = 5;
+const int glyphHeight  = 7;
+const int glyphAdvance = 6;
+const int glyphScale   = 2;
+
+//* full coverage of an opaque color
+const unsigned alphaOne = 256;
+
+unsigned opacity(uint32_t color)
+{
+    return ((color>>24)*alphaOne + 127)/255;
+}
+
+inline void blendPixel(unsigned char *p, uint32_t color, unsigned alpha)
+{
+    const int a = static_cast<int>(alpha);
+    p[0] = static_cast<unsigned char>(p[0] + (static_cast<int>((color>>16) & 0xff) - p[0])*a/256);
+    p[1] = static_cast<unsigned char>(p[1] + (static_cast<int>((color>>8)  & 0xff) - p[1])*a/256);
+    p[2] = static_cast<unsigned char>(p[2] + (static_cast<int>( color      & 0xff) - p[2])*a/256);
+    p[3] = static_cast<unsigned char>(p[3] + (255 - p[3])*a/256);
+}
+
+double segmentDistance(double px, double py, double ax, double ay, double bx, double by)
+{
+    double dx = bx-ax;
+    double dy = by-ay;
+    double length2 = dx*dx + dy*dy;
+    double t = (length2 > 0) ? ((px-ax)*dx + (py-ay)*dy)/length2 : 0;
+    t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+    double ex = px - (ax + t*dx);
+    double ey = py - (ay + t*dy);
+    return sqrt(ex*ex + ey*ey);
+}
+
+double clampUnit(double value)
+{
+    return (value < 0) ? 0 : (value > 1) ? 1 : value;
+}
+
+//* coverage of a one pixel wide outline at distance d from its center line
+double outlineCoverage(double d)
+{
+    return clampUnit(1-d);
+}
+
+double polygonCoverage(const vector<double> &vx, const vector<double> &vy,
+                       bool isFilled, double u, double v)
+{
+    const size_t n = vx.size();
+    double nearest = 1e300;
+    double inside  = -1e300;
+    for (size_t i=0; i<n; ++i) {
+        size_t j = (i+1)%n;
+        nearest = min(nearest, segmentDistance(u, v, vx[i], vy[i], vx[j], vy[j]));
+
+        //* signed distance to the edge line, positive away from the center
+        double ex = vx[j]-vx[i];
+        double ey = vy[j]-vy[i];
+        double length = sqrt(ex*ex + ey*ey);
+        double s = ((u-vx[i])*ey - (v-vy[i])*ex)/length;
+        double s0 = (-vx[i]*ey + vy[i]*ex)/length;
+        inside = max(inside, (s0 > 0) ? -s : s);
+    }
+    double coverage = outlineCoverage(nearest);
+    if (isFilled) {
+        coverage = max(coverage, clampUnit(0.5-inside));
+    }
+    return coverage;
+}
+
+//* coverage at (u, v) from the center of a marker of radius r
+double markerCoverage(int pointType, double r, double u, double v)
+{
+    const int    shape    = (pointType-1)%15+1;
+    const bool   isFilled = shape>=5 && shape%2==1;
+    vector<double> vx;
+    vector<double> vy;
+
+    switch (shape) {
+    case 1:
+        return max(outlineCoverage(segmentDistance(u, v, -r, 0, r, 0)),
+                   outlineCoverage(segmentDistance(u, v, 0, -r, 0, r)));
+    case 2:
+        return max(outlineCoverage(segmentDistance(u, v, -r, -r, r, r)),
+                   outlineCoverage(segmentDistance(u, v, -r, r, r, -r)));
+    case 3:
+        return max(markerCoverage(1, r, u, v), markerCoverage(2, r, u, v));
+    case 4:
+    case 5:
+        vx = {-r, r, r, -r};
+        vy = {-r, -r, r, r};
+        break;
+    case 6:
+    case 7: {
+        double d = sqrt(u*u + v*v);
+        double coverage = outlineCoverage(fabs(d-r));
+        return isFilled ? max(coverage, clampUnit(r+0.5-d)) : coverage;
+    }
+    case 8:
+    case 9:
+        vx = {0, r, -r};
+        vy = {-1.155*r, 0.577*r, 0.577*r};
+        break;
+    case 10:
+    case 11:
+        vx = {0, r, -r};
+        vy = {1.155*r, -0.577*r, -0.577*r};
+        break;
+    case 12:
+    case 13:
+        vx = {0, r, 0, -r};
+        vy = {-r, 0, r, 0};
+        break;
+    default:
+        //* pentagon
+        for (int k=0; k<5; ++k) {
+            double angle = -M_PI/2 + k*2*M_PI/5;
+            vx.push_back(r*cos(angle));
+            vy.push_back(r*sin(angle));
+        }
+    }
+    return polygonCoverage(vx, vy, isFilled, u, v);
+}
+
+}
+
+
+Raster::Raster(unsigned width, unsigned height, uint32_t background)
+    : nWidth(width),
+      nHeight(height),
+      rgba(static_cast<size_t>(width)*height*4),
+      clipLeft(0),
+      clipTop(0),
+      clipRight(width),
+      clipBottom(height)
+{
+    unsigned char pixel[4] = {
+        static_cast<unsigned char>(background>>16),
+        static_cast<unsigned char>(background>>8),
+        static_cast<unsigned char>(background),
+        static_cast<unsigned char>(background>>24)
+    };
+    for (size_t i=0; i<this->rgba.size(); i+=4) {
+        copy(pixel, pixel+4, &this->rgba[i]);
+    }
+}
+
+void Raster::clip(double left, double top, double right, double bottom)
+{
+    this->clipLeft   = max(0, static_cast<int>(floor(left)));
+    this->clipTop    = max(0, static_cast<int>(floor(top)));
+    this->clipRight  = min(static_cast<int>(this->nWidth),  static_cast<int>(ceil(right)));
+    this->clipBottom = min(static_cast<int>(this->nHeight), static_cast<int>(ceil(bottom)));
+}
+
+void Raster::unclip()
+{
+    this->clipLeft   = 0;
+    this->clipTop    = 0;
+    this->clipRight  = this->nWidth;
+    this->clipBottom = this->nHeight;
+}
+
+void Raster::blendSpan(int row, int begin, int end, uint32_t color, unsigned alpha)
+{
+    if (row < this->clipTop || row >= this->clipBottom) {
+        return;
+    }
+    begin = max(begin, this->clipLeft);
+    end   = min(end, this->clipRight);
+    if (begin >= end || alpha == 0) {
+        return;
+    }
+
+    unsigned char *p = &this->rgba[(static_cast<size_t>(row)*this->nWidth + begin)*4];
+    const int n = end-begin;
+    if (alpha >= alphaOne) {
+        //* plain stores over contiguous pixels; vectorized by the compiler
+        const unsigned char r = static_cast<unsigned char>(color>>16);
+        const unsigned char g = static_cast<unsigned char>(color>>8);
+        const unsigned char b = static_cast<unsigned char>(color);
+        for (int i=0; i<n; ++i) {
+            p[4*i]   = r;
+            p[4*i+1] = g;
+            p[4*i+2] = b;
+            p[4*i+3] = 255;
+        }
+    }
+    else {
+        for (int i=0; i<n; ++i) {
+            blendPixel(p+4*i, color, alpha);
+        }
+    }
+}
+
+void Raster::fillRect(double left, double top, double right, double bottom, uint32_t color)
+{
+    const int x0 = static_cast<int>(lround(left));
+    const int x1 = static_cast<int>(lround(right));
+    const int y0 = max(static_cast<int>(lround(top)), this->clipTop);
+    const int y1 = min(static_cast<int>(lround(bottom)), this->clipBottom);
+    const unsigned alpha = opacity(color);
+    for (int row=y0; row<y1; ++row) {
+        blendSpan(row, x0, x1, color, alpha);
+    }
+}
+
+void Raster::strokeSegment(double x0, double y0, double x1, double y1,
+                           double halfWidth, uint32_t color, unsigned alpha)
+{
+    if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1)) {
+        return;
+    }
+
+    //* coverage falls from 1 to 0 over the last pixel of the distance
+    const double reach = halfWidth + 0.5;
+    const double dx = x1-x0;
+    const double dy = y1-y0;
+    const double length = sqrt(dx*dx + dy*dy);
+
+    const double boxLeft  = min(x0, x1) - reach;
+    const double boxRight = max(x0, x1) + reach;
+    const int rowBegin = max(this->clipTop,    static_cast<int>(floor(min(y0, y1) - reach)));
+    const int rowEnd   = min(this->clipBottom, static_cast<int>(ceil(max(y0, y1) + reach)));
+
+    for (int row=rowBegin; row<rowEnd; ++row) {
+        const double yc = row + 0.5;
+
+        //* the capsule lies within the strip of half-width reach around
+        //* the segment's line, and within its bounding box
+        double lo = boxLeft;
+        double hi = boxRight;
+        if (fabs(dy) > 1e-12) {
+            double xc   = x0 + dx*(yc-y0)/dy;
+            double half = reach*length/fabs(dy);
+            lo = max(lo, xc-half);
+            hi = min(hi, xc+half);
+        }
+        else if (fabs(yc-y0) >= reach) {
+            continue;
+        }
+
+        const int begin = max(this->clipLeft,  static_cast<int>(floor(lo)));
+        const int end   = min(this->clipRight, static_cast<int>(ceil(hi)));
+        unsigned char *p = &this->rgba[(static_cast<size_t>(row)*this->nWidth)*4];
+        for (int col=begin; col<end; ++col) {
+            double coverage = reach - segmentDistance(col+0.5, yc, x0, y0, x1, y1);
+            if (coverage <= 0) {
+                continue;
+            }
+            unsigned a = (coverage >= 1) ? alpha : static_cast<unsigned>(coverage*alpha + 0.5);
+            blendPixel(p+4*col, color, a);
+        }
+    }
+}
+
+void Raster::strokeLine(double x0, double y0, double x1, double y1, double lineWidth, uint32_t color)
+{
+    if (lineWidth <= 0) {
+        return;
+    }
+    //* thinner than a pixel: one pixel wide, proportionally lighter
+    unsigned alpha = static_cast<unsigned>(opacity(color)*min(lineWidth, 1.0) + 0.5);
+    strokeSegment(x0, y0, x1, y1, max(lineWidth, 1.0)/2, color, alpha);
+}
+
+void Raster::strokePolyline(const double *x, const double *y, size_t n, double lineWidth,
+                            uint32_t color, const vector<double> &dash)
+{
+    if (lineWidth <= 0 || n < 2) {
+        return;
+    }
+    const unsigned alpha     = static_cast<unsigned>(opacity(color)*min(lineWidth, 1.0) + 0.5);
+    const double   halfWidth = max(lineWidth, 1.0)/2;
+
+    bool isDashed = !dash.empty();
+    for (auto it=dash.begin(); it!=dash.end(); ++it) {
+        isDashed = isDashed && *it > 0;
+    }
+    if (!isDashed) {
+        //* Consecutive points in one pixel column are reduced to the first,
+        //* lowest, highest and last of them: the strokes in between cover
+        //* the same pixels, so a dense series costs as much as the plot is
+        //* wide. Dashes depend on the full path and are drawn unreduced.
+        vector<double> rx;
+        vector<double> ry;
+        size_t i = 0;
+        while (i < n) {
+            const double column = floor(x[i]);
+            size_t last = i;
+            size_t low  = i;
+            size_t high = i;
+            while (last+1 < n && floor(x[last+1]) == column) {
+                ++last;
+                low  = (y[last] < y[low])  ? last : low;
+                high = (y[last] > y[high]) ? last : high;
+            }
+            size_t keep[4] = {i, min(low, high), max(low, high), last};
+            for (int k=0; k<4; ++k) {
+                if (k==0 || keep[k] != keep[k-1]) {
+                    rx.push_back(x[keep[k]]);
+                    ry.push_back(y[keep[k]]);
+                }
+            }
+            i = last+1;
+        }
+        for (size_t k=0; k+1<rx.size(); ++k) {
+            strokeSegment(rx[k], ry[k], rx[k+1], ry[k+1], halfWidth, color, alpha);
+        }
+        return;
+    }
+
+    //* the dash pattern continues across vertices
+    size_t iDash = 0;
+    double remaining = dash[0];
+    for (size_t i=0; i+1<n; ++i) {
+        const double dx = x[i+1]-x[i];
+        const double dy = y[i+1]-y[i];
+        const double length = sqrt(dx*dx + dy*dy);
+        if (!std::isfinite(length)) {
+            continue;
+        }
+        double position = 0;
+        while (position < length) {
+            double step = min(remaining, length-position);
+            if (iDash%2 == 0) {
+                double t0 = position/length;
+                double t1 = (position+step)/length;
+                strokeSegment(x[i]+t0*dx, y[i]+t0*dy, x[i]+t1*dx, y[i]+t1*dy, halfWidth, color, alpha);
+            }
+            position  += step;
+            remaining -= step;
+            if (remaining <= 0) {
+                iDash = (iDash+1)%dash.size();
+                remaining = dash[iDash];
+            }
+        }
+    }
+}
+
+void Raster::fillPolygon(const double *x, const double *y, size_t n, uint32_t color)
+{
+    struct Edge
+    {
+        double yMin;
+        double yMax;
+        double xAtMin;
+        double slope;
+    };
+
+    //* the edges between consecutive finite points, the last one closing
+    vector<double> vx;
+    vector<double> vy;
+    for (size_t i=0; i<n; ++i) {
+        if (std::isfinite(x[i]) && std::isfinite(y[i])) {
+            vx.push_back(x[i]);
+            vy.push_back(y[i]);
+        }
+    }
+    vector<Edge> edges;
+    for (size_t i=0; i<vx.size(); ++i) {
+        size_t j = (i+1)%vx.size();
+        if (vy[i] == vy[j]) {
+            continue;
+        }
+        size_t lo = (vy[i] < vy[j]) ? i : j;
+        size_t hi = (vy[i] < vy[j]) ? j : i;
+        edges.push_back(Edge{vy[lo], vy[hi], vx[lo], (vx[hi]-vx[lo])/(vy[hi]-vy[lo])});
+    }
+    if (edges.empty()) {
+        return;
+    }
+    sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) { return a.yMin < b.yMin; });
+
+    const int nSample = 4;
+    const unsigned alpha = opacity(color);
+    const int rowBegin = max(this->clipTop, static_cast<int>(floor(edges.front().yMin)));
+    vector<int> coverage(this->nWidth + 1);
+    vector<const Edge*> active;
+    vector<double> crossings;
+    size_t next = 0;
+    for (int row=rowBegin; row<this->clipBottom; ++row) {
+        fill(coverage.begin(), coverage.end(), 0);
+        int columnBegin = this->clipRight;
+        int columnEnd   = this->clipLeft;
+        for (int k=0; k<nSample; ++k) {
+            const double scanY = row + (k+0.5)/nSample;
+            while (next < edges.size() && edges[next].yMin <= scanY) {
+                active.push_back(&edges[next++]);
+            }
+            active.erase(remove_if(active.begin(), active.end(),
+                                   [scanY](const Edge *e) { return e->yMax <= scanY; }),
+                         active.end());
+
+            crossings.clear();
+            for (auto it=active.begin(); it!=active.end(); ++it) {
+                crossings.push_back((*it)->xAtMin + (scanY - (*it)->yMin)*(*it)->slope);
+            }
+            sort(crossings.begin(), crossings.end());
+
+            //* pixels whose centers lie between a pair of crossings
+            for (size_t c=0; c+1<crossings.size(); c+=2) {
+                int begin = max(this->clipLeft,  static_cast<int>(ceil(crossings[c]-0.5)));
+                int end   = min(this->clipRight, static_cast<int>(ceil(crossings[c+1]-0.5)));
+                if (begin < end) {
+                    ++coverage[begin];
+                    --coverage[end];
+                    columnBegin = min(columnBegin, begin);
+                    columnEnd   = max(columnEnd, end);
+                }
+            }
+        }
+
+        //* runs of equal coverage are blended as spans
+        int count = 0;
+        int spanBegin = columnBegin;
+        for (int column=columnBegin; column<columnEnd; ++column) {
+            int countNext = count + coverage[column];
+            if (countNext != count) {
+                blendSpan(row, spanBegin, column, color, alpha*count/nSample);
+                spanBegin = column;
+                count = countNext;
+            }
+        }
+        blendSpan(row, spanBegin, columnEnd, color, alpha*count/nSample);
+
+        if (next == edges.size() && active.empty()) {
+            break;
+        }
+    }
+}
+
+void Raster::drawMarkers(const double *x, const double *y, size_t n,
+                         int pointType, double radius, uint32_t color)
+{
+    if (pointType <= 0 || radius <= 0) {
+        return;
+    }
+
+    //* marker centered on a pixel center, rasterized once
+    const int reach = static_cast<int>(ceil(radius*1.2 + 1.5));
+    const int side  = 2*reach+1;
+    const unsigned alpha = opacity(color);
+    vector<unsigned short> stamp(side*side);
+    for (int j=0; j<side; ++j) {
+        for (int i=0; i<side; ++i) {
+            double coverage = markerCoverage(pointType, radius, i-reach, j-reach);
+            stamp[j*side+i] = static_cast<unsigned short>(coverage*alpha + 0.5);
+        }
+    }
+
+    //* a marker stamped twice on the same pixel would only darken its edges
+    vector<bool> isStamped(static_cast<size_t>(this->nWidth)*this->nHeight);
+    for (size_t k=0; k<n; ++k) {
+        if (!std::isfinite(x[k]) || !std::isfinite(y[k])) {
+            continue;
+        }
+        const double cx = floor(x[k]);
+        const double cy = floor(y[k]);
+        if (cx+reach < this->clipLeft || cx-reach >= this->clipRight
+                || cy+reach < this->clipTop || cy-reach >= this->clipBottom) {
+            continue;
+        }
+        if (cx >= 0 && cx < this->nWidth && cy >= 0 && cy < this->nHeight) {
+            size_t center = static_cast<size_t>(cy)*this->nWidth + static_cast<size_t>(cx);
+            if (isStamped[center]) {
+                continue;
+            }
+            isStamped[center] = true;
+        }
+        const int left = static_cast<int>(cx) - reach;
+        const int top  = static_cast<int>(cy) - reach;
+        const int jBegin = max(0, this->clipTop-top);
+        const int jEnd   = min(side, this->clipBottom-top);
+        const int iBegin = max(0, this->clipLeft-left);
+        const int iEnd   = min(side, this->clipRight-left);
+        for (int j=jBegin; j<jEnd; ++j) {
+            unsigned char *p = &this->rgba[(static_cast<size_t>(top+j)*this->nWidth + left)*4];
+            const unsigned short *s = &stamp[j*side];
+            for (int i=iBegin; i<iEnd; ++i) {
+                if (s[i] > 0) {
+                    blendPixel(p+4*i, color, s[i]);
+                }
+            }
+        }
+    }
+}
+
+void Raster::drawText(double x, double y, const string &text, uint32_t color,
+                      TextAlign align, bool isVertical)
+{
+    const double width  = textWidth(text);
+    const double height = textHeight();
+    const double shift  = (align==ALIGN_CENTER) ? width/2 : (align==ALIGN_RIGHT) ? width : 0;
+
+    //* whole pixels, so that every font pixel becomes an equal square
+    const double x0 = floor(isVertical ? x - height/2 : x - shift);
+    const double y0 = floor(isVertical ? y + shift    : y - height/2);
+    const int    s  = glyphScale;
+
+    for (size_t k=0; k<text.size(); ++k) {
+        unsigned char c = static_cast<unsigned char>(text[k]);
+        const unsigned char *glyph = font[(c>=32 && c<127) ? c-32 : '?'-32];
+        for (int row=0; row<glyphHeight; ++row) {
+            for (int col=0; col<glyphWidth; ++col) {
+                if (!(glyph[row] & (1 << (glyphWidth-1-col)))) {
+                    continue;
+                }
+                double u = (k*glyphAdvance + col)*s;
+                double v = row*s;
+                if (isVertical) {
+                    fillRect(x0+v, y0-u-s, x0+v+s, y0-u, color);
+                }
+                else {
+                    fillRect(x0+u, y0+v, x0+u+s, y0+v+s, color);
+                }
+            }
+        }
+    }
+}
+
+double Raster::textWidth(const string &text)
+{
+    return text.empty() ? 0 : (text.size()*glyphAdvance - (glyphAdvance-glyphWidth))*glyphScale;
+}
+
+double Raster::textHeight()
+{
+    return glyphHeight*glyphScale;
+}
+
+
+}
@@ -0,0 +1,265 @@
+#include "rendercache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #include <io.h>
+    #include <process.h>
+    #include <sys/utime.h>
+    #define getpid _getpid
+    #define utime  _utime
+#else
+    #include <dirent.h>
+    #include <unistd.h>
+    #include <utime.h>
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+const uint64_t murmurMultiplier = 0xc6a4a7935bd1e995ull;
+const int      murmurShift      = 47;
+
+//* unique names for files written aside, across threads and processes
+string asideName(const string &filename)
+{
+    static atomic<unsigned long> count(0);
+    return filename + ".tmp" + to_string(static_cast<long long>(getpid()))
+            + "-" + to_string(++count);
+}
+
+//* copies through a file written aside, so to is complete or unchanged
+bool copyFile(const string &from, const string &to)
+{
+    string filenameTmp = asideName(to);
+    {
+        ifstream fin(from.c_str(), ios::in | ios::binary);
+        if (!fin) {
+            return false;
+        }
+        ofstream fout(filenameTmp.c_str(), ios::out | ios::binary);
+        fout << fin.rdbuf();
+        if (!fout) {
+            fout.close();
+            remove(filenameTmp.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    //* rename() does not replace an existing file on Windows
+    remove(to.c_str());
+#endif
+    if (rename(filenameTmp.c_str(), to.c_str()) != 0) {
+        remove(filenameTmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+struct Entry
+{
+    string             filename;
+    unsigned long long size;
+    time_t             used;
+};
+
+//* regular files of dir; names starting with '.' are skipped
+vector<Entry> listEntries(const string &dir)
+{
+    vector<Entry> entries;
+#ifdef _WIN32
+    _finddata_t found;
+    intptr_t handle = _findfirst((dir + "/*").c_str(), &found);
+    if (handle == -1) {
+        return entries;
+    }
+    do {
+        if (found.name[0] != '.' && !(found.attrib & _A_SUBDIR)) {
+            entries.push_back({dir + "/" + found.name, static_cast<unsigned long long>(found.size),
+                               found.time_write});
+        }
+    } while (_findnext(handle, &found) == 0);
+    _findclose(handle);
+#else
+    DIR *handle = opendir(dir.c_str());
+    if (handle == nullptr) {
+        return entries;
+    }
+    while (dirent *found = readdir(handle)) {
+        if (found->d_name[0] == '.') {
+            continue;
+        }
+        string filename = dir + "/" + found->d_name;
+        struct stat st;
+        if (stat(filename.c_str(), &st)==0 && S_ISREG(st.st_mode)) {
+            entries.push_back({filename, static_cast<unsigned long long>(st.st_size), st.st_mtime});
+        }
+    }
+    closedir(handle);
+#endif
+    return entries;
+}
+
+}
+
+
+Hasher::Hasher()
+    : state(0x9e3779b97f4a7c15ull),
+      length(0)
+{
+}
+
+void Hasher::add(uint64_t value)
+{
+    value *= murmurMultiplier;
+    value ^= value >> murmurShift;
+    value *= murmurMultiplier;
+    this->state ^= value;
+    this->state *= murmurMultiplier;
+    ++(this->length);
+}
+
+void Hasher::add(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    add(bits);
+}
+
+void Hasher::add(const string &text)
+{
+    //* the length first, so that "ab","c" and "a","bc" differ
+    add(static_cast<uint64_t>(text.size()));
+    size_t i = 0;
+    for (; i+8 <= text.size(); i+=8) {
+        uint64_t word;
+        memcpy(&word, text.data()+i, sizeof(word));
+        add(word);
+    }
+    if (i < text.size()) {
+        uint64_t word = 0;
+        memcpy(&word, text.data()+i, text.size()-i);
+        add(word);
+    }
+}
+
+void Hasher::add(const DataView &data)
+{
+    add(static_cast<uint64_t>(data.size()));
+    for (size_t i=0; i<data.size(); ++i) {
+        add(data[i]);
+    }
+}
+
+uint64_t Hasher::digest() const
+{
+    uint64_t h = this->state ^ (this->length * murmurMultiplier);
+    h ^= h >> murmurShift;
+    h *= murmurMultiplier;
+    h ^= h >> murmurShift;
+    return h;
+}
+
+string Hasher::hex() const
+{
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(digest()));
+    return buffer;
+}
+
+
+RenderCache::RenderCache(const string &dir, unsigned long long maxBytes)
+    : dirname(dir),
+      maxBytes(maxBytes)
+{
+#ifdef _WIN32
+    int status = _mkdir(dir.c_str());
+#else
+    int status = mkdir(dir.c_str(), 0755);
+#endif
+    if (status!=0 && errno!=EEXIST) {
+        throw runtime_error("Cannot create cache directory " + dir + ": " + strerror(errno));
+    }
+}
+
+const string &RenderCache::path() const
+{
+    return this->dirname;
+}
+
+unsigned long long RenderCache::capacity() const
+{
+    return this->maxBytes;
+}
+
+bool RenderCache::fetch(const string &key, const string &filename) const
+{
+    string cached = entry(key);
+    if (!copyFile(cached, filename)) {
+        return false;
+    }
+    //* most recently used; eviction goes by modification time
+    utime(cached.c_str(), nullptr);
+    return true;
+}
+
+void RenderCache::store(const string &key, const string &filename)
+{
+    //* a cache that cannot be written only costs the next render
+    if (copyFile(filename, entry(key))) {
+        evict();
+    }
+}
+
+void RenderCache::clear()
+{
+    vector<Entry> entries = listEntries(this->dirname);
+    for (auto it=entries.begin(); it!=entries.end(); ++it) {
+        remove(it->filename.c_str());
+    }
+}
+
+string RenderCache::entry(const string &key) const
+{
+    return this->dirname + "/" + key;
+}
+
+void RenderCache::evict()
+{
+    vector<Entry> entries = listEntries(this->dirname);
+    unsigned long long size = 0;
+    for (auto it=entries.begin(); it!=entries.end(); ++it) {
+        size += it->size;
+    }
+    if (size <= this->maxBytes) {
+        return;
+    }
+
+    sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.used < b.used;
+    });
+    for (auto it=entries.begin(); it!=entries.end() && size > this->maxBytes; ++it) {
+        if (remove(it->filename.c_str()) == 0) {
+            size -= it->size;
+        }
+    }
+}
+
+
+}
@@ -0,0 +1,107 @@
+#include "renderpool.h"
+
+#include "parallel.h"
+
+using namespace std;
+
+namespace eggp{
+
+
+RenderPool &RenderPool::instance()
+{
+    static RenderPool pool;
+    return pool;
+}
+
+RenderPool::RenderPool()
+    : workers(),
+      queue(),
+      mutex(),
+      hasTask(),
+      hasRoom(),
+      isIdle(),
+      concurrency(defaultThreadCount()),
+      queueDepth(64),
+      nBusy(0),
+      isStopping(false)
+{
+}
+
+RenderPool::~RenderPool()
+{
+    {
+        lock_guard<std::mutex> lock(this->mutex);
+        this->isStopping = true;
+    }
+    this->hasTask.notify_all();
+    for (auto it=this->workers.begin(); it!=this->workers.end(); ++it) {
+        it->join();
+    }
+}
+
+void RenderPool::configure(unsigned concurrency, size_t queueDepth)
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    this->concurrency = (concurrency==0) ? defaultThreadCount() : concurrency;
+    this->queueDepth  = (queueDepth==0) ? 1 : queueDepth;
+    this->hasRoom.notify_all();
+}
+
+future<void> RenderPool::submit(const function<void()> &task)
+{
+    Task packaged = make_shared<packaged_task<void()>>(task);
+    future<void> result = packaged->get_future();
+
+    unique_lock<std::mutex> lock(this->mutex);
+    this->hasRoom.wait(lock, [this]() { return this->queue.size() < this->queueDepth; });
+    this->queue.push_back(packaged);
+
+    //* workers are started on demand, up to the concurrency limit
+    if (this->workers.size() < this->concurrency
+            && this->nBusy + this->queue.size() > this->workers.size()) {
+        this->workers.push_back(thread(&RenderPool::worker, this));
+    }
+    lock.unlock();
+    this->hasTask.notify_one();
+
+    return result;
+}
+
+void RenderPool::wait()
+{
+    unique_lock<std::mutex> lock(this->mutex);
+    this->isIdle.wait(lock, [this]() { return this->queue.empty() && this->nBusy==0; });
+}
+
+void RenderPool::worker()
+{
+    unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        //* a lowered concurrency limit keeps surplus workers waiting
+        this->hasTask.wait(lock, [this]() {
+            return this->isStopping
+                    || (!this->queue.empty() && this->nBusy < this->concurrency);
+        });
+        if (this->queue.empty()) {
+            return;  // stopping and drained
+        }
+
+        Task task = this->queue.front();
+        this->queue.pop_front();
+        ++(this->nBusy);
+        this->hasRoom.notify_one();
+
+        lock.unlock();
+        (*task)();  // exceptions are stored in the future
+        lock.lock();
+
+        --(this->nBusy);
+        if (this->queue.empty() && this->nBusy==0) {
+            this->isIdle.notify_all();
+        }
+        this->hasTask.notify_one();
+    }
+}
+
+
+}
@@ -0,0 +1,259 @@
+#include "session.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+
+GnuplotSession::GnuplotSession(const string &command)
+    : command(command),
+      lastMessages(),
+      mutex(),
+      syncCount(0),
+      startCount(0),
+#ifdef _WIN32
+      pipe(nullptr)
+#else
+      pid(-1),
+      fdIn(-1),
+      fdErr(-1)
+#endif
+{
+}
+
+GnuplotSession::~GnuplotSession()
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    stop();
+}
+
+void GnuplotSession::run(const string &script)
+{
+    lock_guard<std::mutex> lock(this->mutex);
+
+    if (!isRunning()) {
+        start();
+    }
+
+    //* gnuplot prints to stderr by default, which is unbuffered, so the
+    //* marker comes back as soon as everything before it is done
+    string marker = "EGGP-SYNC-" + to_string(++(this->syncCount));
+    string payload = script;
+    if (!payload.empty() && payload.back()!='\n') {
+        payload += '\n';
+    }
+    payload += "print '" + marker + "'\n";
+
+    if (!write(payload) || !waitFor(marker)) {
+        string message = this->lastMessages;
+        stop();
+        throw runtime_error("gnuplot session terminated unexpectedly: " + message);
+    }
+}
+
+string GnuplotSession::messages() const
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    return this->lastMessages;
+}
+
+unsigned long GnuplotSession::processCount() const
+{
+    lock_guard<std::mutex> lock(this->mutex);
+    return this->startCount;
+}
+
+shared_ptr<GnuplotSession> GnuplotSession::shared()
+{
+    static shared_ptr<GnuplotSession> session = make_shared<GnuplotSession>();
+    return session;
+}
+
+
+#ifdef _WIN32
+
+//* Windows pipes are one-way: scripts are sent but completion cannot be
+//* observed, so run() returns once gnuplot has received the script.
+
+bool GnuplotSession::isRunning() const
+{
+    return this->pipe != nullptr;
+}
+
+void GnuplotSession::start()
+{
+    this->pipe = _popen(this->command.c_str(), "w");
+    if (this->pipe == nullptr) {
+        throw runtime_error("Cannot start gnuplot: " + this->command);
+    }
+    ++(this->startCount);
+}
+
+void GnuplotSession::stop()
+{
+    if (this->pipe != nullptr) {
+        _pclose(this->pipe);
+        this->pipe = nullptr;
+    }
+}
+
+bool GnuplotSession::write(const string &data)
+{
+    return fwrite(data.data(), 1, data.size(), this->pipe)==data.size()
+            && fflush(this->pipe)==0;
+}
+
+bool GnuplotSession::waitFor(const string &)
+{
+    this->lastMessages.clear();
+    return true;
+}
+
+#else
+
+bool GnuplotSession::isRunning() const
+{
+    return this->pid > 0;
+}
+
+void GnuplotSession::start()
+{
+    int pipeIn[2];
+    int pipeErr[2];
+    if (::pipe(pipeIn)!=0) {
+        throw runtime_error("Cannot create pipe for gnuplot: " + string(strerror(errno)));
+    }
+    if (::pipe(pipeErr)!=0) {
+        ::close(pipeIn[0]);
+        ::close(pipeIn[1]);
+        throw runtime_error("Cannot create pipe for gnuplot: " + string(strerror(errno)));
+    }
+
+    //* keep our ends out of other children (e.g. other sessions)
+    fcntl(pipeIn[1],  F_SETFD, FD_CLOEXEC);
+    fcntl(pipeErr[0], F_SETFD, FD_CLOEXEC);
+
+    //* prepared before fork: only async-signal-safe calls in the child
+    string shellCommand = "exec " + this->command;
+
+    pid_t child = fork();
+    if (child < 0) {
+        ::close(pipeIn[0]);
+        ::close(pipeIn[1]);
+        ::close(pipeErr[0]);
+        ::close(pipeErr[1]);
+        throw runtime_error("Cannot start gnuplot: " + string(strerror(errno)));
+    }
+    if (child == 0) {
+        dup2(pipeIn[0],  STDIN_FILENO);
+        dup2(pipeErr[1], STDERR_FILENO);
+        ::close(pipeIn[0]);
+        ::close(pipeErr[1]);
+        execl("/bin/sh", "sh", "-c", shellCommand.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    ::close(pipeIn[0]);
+    ::close(pipeErr[1]);
+    ++(this->startCount);
+    this->pid   = child;
+    this->fdIn  = pipeIn[1];
+    this->fdErr = pipeErr[0];
+}
+
+void GnuplotSession::stop()
+{
+    if (this->fdIn >= 0) {
+        ::close(this->fdIn);  // EOF makes gnuplot quit
+        this->fdIn = -1;
+    }
+    if (this->fdErr >= 0) {
+        ::close(this->fdErr);
+        this->fdErr = -1;
+    }
+    if (this->pid > 0) {
+        int status;
+        waitpid(this->pid, &status, 0);
+        this->pid = -1;
+    }
+}
+
+bool GnuplotSession::write(const string &data)
+{
+    //* A dead gnuplot must surface as an error rather than SIGPIPE, so the
+    //* signal is blocked in this thread and discarded if it was raised.
+    sigset_t sigPipe, sigOld;
+    sigemptyset(&sigPipe);
+    sigaddset(&sigPipe, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigPipe, &sigOld);
+
+    bool isOk = true;
+    const char *p = data.data();
+    size_t left = data.size();
+    while (left > 0) {
+        ssize_t n = ::write(this->fdIn, p, left);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EPIPE) {
+                struct timespec zero = {0, 0};
+                sigtimedwait(&sigPipe, nullptr, &zero);
+            }
+            isOk = false;
+            break;
+        }
+        p    += n;
+        left -= n;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &sigOld, nullptr);
+    return isOk;
+}
+
+bool GnuplotSession::waitFor(const string &marker)
+{
+    this->lastMessages.clear();
+
+    string line;
+    char   buffer[4096];
+    while (true) {
+        ssize_t n = ::read(this->fdErr, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            this->lastMessages += line;
+            return false;
+        }
+        for (ssize_t i=0; i<n; ++i) {
+            if (buffer[i] != '\n') {
+                line += buffer[i];
+                continue;
+            }
+            if (line == marker) {
+                return true;
+            }
+            this->lastMessages += line + '\n';
+            line.clear();
+        }
+    }
+}
+
+#endif
+
+
+}
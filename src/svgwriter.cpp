@@ -0,0 +1,355 @@
+#include "svgwriter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "color.h"
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+
+namespace {
+
+const char *fontStyle = "font-family='Arial, Helvetica, sans-serif' font-size='12'";
+
+string escape(const string &text)
+{
+    string result;
+    for (auto it=text.begin(); it!=text.end(); ++it) {
+        switch (*it) {
+        case '&':  result += "&amp;";  break;
+        case '<':  result += "&lt;";   break;
+        case '>':  result += "&gt;";   break;
+        case '"':  result += "&quot;"; break;
+        case '\'': result += "&apos;"; break;
+        default:   result += *it;
+        }
+    }
+    return result;
+}
+
+void appendf(string &out, const char *format, double a)
+{
+    char buffer[64];
+    int n = snprintf(buffer, sizeof(buffer), format, a);
+    out.append(buffer, n);
+}
+
+void appendf(string &out, const char *format, double a, double b)
+{
+    char buffer[64];
+    int n = snprintf(buffer, sizeof(buffer), format, a, b);
+    out.append(buffer, n);
+}
+
+//* "#rrggbb" for the paint, and an opacity attribute if not opaque
+string paintColor(uint32_t argb)
+{
+    char buffer[maxColorTextLength];
+    return string(buffer, formatColor(buffer, argb | 0xff000000u));
+}
+
+string opacity(uint32_t argb)
+{
+    if ((argb >> 24) == 0xff) {
+        return string();
+    }
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), " opacity='%.3g'", (argb >> 24)/255.0);
+    return buffer;
+}
+
+string dashArray(LineType lineType, double lineWidth)
+{
+    double w = (lineWidth < 1) ? 1 : lineWidth;
+    char buffer[128];
+    switch (lineType) {
+    case LINE_DASHED:
+        snprintf(buffer, sizeof(buffer), " stroke-dasharray='%g,%g'", 8*w, 4*w);
+        break;
+    case LINE_DOTTED:
+        snprintf(buffer, sizeof(buffer), " stroke-dasharray='%g,%g'", 2*w, 4*w);
+        break;
+    case LINE_DASHDOT:
+        snprintf(buffer, sizeof(buffer), " stroke-dasharray='%g,%g,%g,%g'", 8*w, 4*w, 2*w, 4*w);
+        break;
+    default:
+        return "";
+    }
+    return buffer;
+}
+
+//* marker outline relative to its center, following gnuplot's point types
+//* 1-15 of the cairo and svg terminals; even types from 4 on are open
+string markerPath(int pointType, double r)
+{
+    char buffer[256];
+    switch ((pointType-1)%15+1) {
+    case 1:
+        snprintf(buffer, sizeof(buffer), "m%g 0h%gm%g %gv%gm0 %g", -r, 2*r, -r, -r, 2*r, -r);
+        break;
+    case 2:
+        snprintf(buffer, sizeof(buffer), "m%g %gl%g %gm0 %gl%g %gm%g %g",
+                 -r, -r, 2*r, 2*r, -2*r, -2*r, 2*r, r, -r);
+        break;
+    case 3:
+        return markerPath(1, r) + markerPath(2, r);
+    case 4:
+    case 5:
+        snprintf(buffer, sizeof(buffer), "m%g %gh%gv%gh%gzm%g %g", -r, -r, 2*r, 2*r, -2*r, r, r);
+        break;
+    case 6:
+    case 7:
+        snprintf(buffer, sizeof(buffer), "m%g 0a%g %g 0 1 0 %g 0a%g %g 0 1 0 %g 0zm%g 0",
+                 -r, r, r, 2*r, r, r, -2*r, r);
+        break;
+    case 8:
+    case 9:
+        snprintf(buffer, sizeof(buffer), "m0 %gl%g %gh%gzm0 %g", -1.155*r, r, 1.732*r, -2*r, 1.155*r);
+        break;
+    case 10:
+    case 11:
+        snprintf(buffer, sizeof(buffer), "m0 %gl%g %gh%gzm0 %g", 1.155*r, r, -1.732*r, -2*r, -1.155*r);
+        break;
+    case 12:
+    case 13:
+        snprintf(buffer, sizeof(buffer), "m0 %gl%g %gl%g %gl%g %gzm0 %g", -r, r, r, -r, r, -r, -r, r);
+        break;
+    default: {
+        //* pentagon
+        string path = "m0 " + to_string(-r);
+        double px = 0;
+        double py = -r;
+        for (int k=1; k<=5; ++k) {
+            double angle = -M_PI/2 + k*2*M_PI/5;
+            double qx = r*cos(angle);
+            double qy = r*sin(angle);
+            appendf(path, "l%.2f %.2f", qx-px, qy-py);
+            px = qx;
+            py = qy;
+        }
+        return path + "zm0 " + to_string(r);
+    }
+    }
+    return buffer;
+}
+
+bool isFilledMarker(int pointType)
+{
+    int shape = (pointType-1)%15+1;
+    return shape>=5 && shape%2==1;
+}
+
+}
+
+
+void writeSvg(ostream &out, const FigureSpec &figure, unsigned width, unsigned height)
+{
+    const Frame frame(figure, width, height);
+    const vector<double> xTicks = frame.x.ticks();
+    const vector<double> yTicks = frame.y.ticks();
+
+    string svg;
+    char buffer[512];
+
+    snprintf(buffer, sizeof(buffer),
+             "<?xml version='1.0' encoding='utf-8'?>\n"
+             "<svg xmlns='http://www.w3.org/2000/svg' width='%u' height='%u' viewBox='0 0 %u %u'>\n"
+             "<!-- Automatically generated by eggplot -->\n"
+             "<rect width='100%%' height='100%%' fill='white'/>\n"
+             "<defs><clipPath id='plot'><rect x='%.2f' y='%.2f' width='%.2f' height='%.2f'/></clipPath></defs>\n",
+             width, height, width, height,
+             frame.left, frame.top, frame.right-frame.left, frame.bottom-frame.top);
+    svg += buffer;
+
+    //* grid
+    if (figure.isGridded) {
+        svg += "<path stroke='" + LineSpec::gridColor + "' stroke-width='1' stroke-dasharray='2,4' fill='none' d='";
+        for (auto it=xTicks.begin(); it!=xTicks.end(); ++it) {
+            appendf(svg, "M%.2f %.2f", frame.toPixelX(*it), frame.top);
+            appendf(svg, "V%.2f", frame.bottom);
+        }
+        for (auto it=yTicks.begin(); it!=yTicks.end(); ++it) {
+            appendf(svg, "M%.2f %.2f", frame.left, frame.toPixelY(*it));
+            appendf(svg, "H%.2f", frame.right);
+        }
+        svg += "'/>\n";
+    }
+
+    //* border, ticks (mirrored) and tick labels
+    snprintf(buffer, sizeof(buffer),
+             "<rect x='%.2f' y='%.2f' width='%.2f' height='%.2f' fill='none' stroke='black'/>\n",
+             frame.left, frame.top, frame.right-frame.left, frame.bottom-frame.top);
+    svg += buffer;
+
+    const double tickLength = 6;
+    svg += "<path stroke='black' d='";
+    for (auto it=xTicks.begin(); it!=xTicks.end(); ++it) {
+        double px = frame.toPixelX(*it);
+        appendf(svg, "M%.2f %.2f", px, frame.bottom);
+        appendf(svg, "v%.2fM%.2f", -tickLength, px);
+        appendf(svg, " %.2fv%.2f", frame.top, tickLength);
+    }
+    for (auto it=yTicks.begin(); it!=yTicks.end(); ++it) {
+        double py = frame.toPixelY(*it);
+        appendf(svg, "M%.2f %.2f", frame.left, py);
+        appendf(svg, "h%.2fM%.2f", tickLength, frame.right);
+        appendf(svg, " %.2fh%.2f", py, -tickLength);
+    }
+    svg += "'/>\n";
+
+    svg += string("<g ") + fontStyle + " text-anchor='middle'>\n";
+    for (auto it=xTicks.begin(); it!=xTicks.end(); ++it) {
+        appendf(svg, "<text x='%.2f' y='%.2f'>", frame.toPixelX(*it), frame.bottom+16);
+        svg += escape(frame.x.tickLabel(*it)) + "</text>\n";
+    }
+    svg += "</g>\n";
+    svg += string("<g ") + fontStyle + " text-anchor='end'>\n";
+    for (auto it=yTicks.begin(); it!=yTicks.end(); ++it) {
+        appendf(svg, "<text x='%.2f' y='%.2f'>", frame.left-6, frame.toPixelY(*it)+4);
+        svg += escape(frame.y.tickLabel(*it)) + "</text>\n";
+    }
+    svg += "</g>\n";
+
+    //* title and axis labels
+    double centerX = (frame.left+frame.right)/2;
+    double centerY = (frame.top+frame.bottom)/2;
+    if (!figure.title.empty()) {
+        appendf(svg, "<text x='%.2f' y='%.2f' text-anchor='middle' ", centerX, frame.top-12);
+        svg += string(fontStyle) + ">" + escape(figure.title) + "</text>\n";
+    }
+    if (!figure.xlabel.empty()) {
+        appendf(svg, "<text x='%.2f' y='%.2f' text-anchor='middle' ", centerX, frame.bottom+38);
+        svg += string(fontStyle) + ">" + escape(figure.xlabel) + "</text>\n";
+    }
+    if (!figure.ylabel.empty()) {
+        snprintf(buffer, sizeof(buffer), "<text transform='translate(%.2f,%.2f) rotate(-90)' text-anchor='middle' ",
+                 frame.left-54, centerY);
+        svg += string(buffer) + fontStyle + ">" + escape(figure.ylabel) + "</text>\n";
+    }
+
+    //* curves: one path for the line and one for all markers of a curve
+    svg += "<g clip-path='url(#plot)' fill='none' stroke-linejoin='round'>\n";
+    out << svg;
+    svg.clear();
+
+    for (size_t iCurve=0; iCurve<figure.curves.size(); ++iCurve) {
+        const DataView &x    = figure.curves[iCurve].first;
+        const DataView &y    = figure.curves[iCurve].second;
+        const LineSpec &spec = figure.lineSpec[iCurve];
+        const string color   = paintColor(spec.style().color);
+        const string alpha   = opacity(spec.style().color);
+        const double width   = spec.getLineWidth();
+
+        if (iCurve < figure.nBand) {
+            //* a closed polygon without its points that are not finite,
+            //* filled as Raster::fillPolygon() does
+            const uint32_t fill = bandColor(figure.lineSpec[figure.nBand].style().color);
+            snprintf(buffer, sizeof(buffer), "<path fill='%s' fill-opacity='%.3g' fill-rule='evenodd' stroke='none' d='",
+                     paintColor(fill).c_str(), (fill >> 24)/255.0);
+            svg += buffer;
+            bool isPenDown = false;
+            for (size_t i=0; i<x.size(); ++i) {
+                if (!std::isfinite(x[i]) || !std::isfinite(y[i])) {
+                    continue;
+                }
+                svg += isPenDown ? 'L' : 'M';
+                appendf(svg, "%.2f %.2f", frame.toPixelX(x[i]), frame.toPixelY(y[i]));
+                isPenDown = true;
+            }
+            svg += "Z'/>\n";
+            out << svg;
+            svg.clear();
+            continue;
+        }
+
+        if (!spec.isPointOnly() && width > 0) {
+            snprintf(buffer, sizeof(buffer), "<path stroke='%s'%s stroke-width='%g'%s d='",
+                     color.c_str(), alpha.c_str(), width, dashArray(spec.getLineType(), width).c_str());
+            svg += buffer;
+            bool isPenDown = false;
+            for (size_t i=0; i<x.size(); ++i) {
+                if (!std::isfinite(x[i]) || !std::isfinite(y[i])) {
+                    isPenDown = false;
+                    continue;
+                }
+                svg += isPenDown ? 'L' : 'M';
+                appendf(svg, "%.2f %.2f", frame.toPixelX(x[i]), frame.toPixelY(y[i]));
+                isPenDown = true;
+            }
+            svg += "'/>\n";
+        }
+
+        int pointType = spec.getPointType(TERM_SVG);
+        if (pointType > 0 && spec.getPointSize() > 0) {
+            const string marker = markerPath(pointType, 4*spec.getPointSize());
+            if (isFilledMarker(pointType)) {
+                snprintf(buffer, sizeof(buffer), "<path fill='%s' stroke='%s'%s d='",
+                         color.c_str(), color.c_str(), alpha.c_str());
+            }
+            else {
+                snprintf(buffer, sizeof(buffer), "<path stroke='%s'%s d='", color.c_str(), alpha.c_str());
+            }
+            svg += buffer;
+            for (size_t i=0; i<x.size(); ++i) {
+                if (!std::isfinite(x[i]) || !std::isfinite(y[i])) {
+                    continue;
+                }
+                appendf(svg, "M%.2f %.2f", frame.toPixelX(x[i]), frame.toPixelY(y[i]));
+                svg += marker;
+            }
+            svg += "'/>\n";
+        }
+
+        out << svg;
+        svg.clear();
+    }
+    svg += "</g>\n";
+
+    //* legend, top right inside the plot as gnuplot's default key
+    for (size_t iCurve=0; iCurve<figure.curves.size() && iCurve<figure.legend.size(); ++iCurve) {
+        const LineSpec &spec = figure.lineSpec[iCurve];
+        const string color   = paintColor(spec.style().color);
+        const string alpha   = opacity(spec.style().color);
+        double py     = frame.top + 14 + 16*iCurve;
+        double sample = frame.right - 50;
+
+        appendf(svg, "<text x='%.2f' y='%.2f' text-anchor='end' ", sample-8, py+4);
+        svg += string(fontStyle) + ">" + escape(figure.legend[iCurve]) + "</text>\n";
+        if (iCurve < figure.nBand) {
+            const uint32_t fill = bandColor(figure.lineSpec[figure.nBand].style().color);
+            snprintf(buffer, sizeof(buffer),
+                     "<rect x='%.2f' y='%.2f' width='40' height='10' fill='%s' fill-opacity='%.3g'/>\n",
+                     sample, py-5, paintColor(fill).c_str(), (fill >> 24)/255.0);
+            svg += buffer;
+            continue;
+        }
+        if (!spec.isPointOnly()) {
+            snprintf(buffer, sizeof(buffer),
+                     "<path stroke='%s'%s stroke-width='%g'%s d='M%.2f %.2fh40'/>\n",
+                     color.c_str(), alpha.c_str(), spec.getLineWidth(),
+                     dashArray(spec.getLineType(), spec.getLineWidth()).c_str(), sample, py);
+            svg += buffer;
+        }
+        int pointType = spec.getPointType(TERM_SVG);
+        if (pointType > 0 && spec.getPointSize() > 0) {
+            snprintf(buffer, sizeof(buffer), "<path fill='%s' stroke='%s'%s d='M%.2f %.2f",
+                     isFilledMarker(pointType) ? color.c_str() : "none", color.c_str(),
+                     alpha.c_str(), sample+20, py);
+            svg += buffer + markerPath(pointType, 4*spec.getPointSize()) + "'/>\n";
+        }
+    }
+
+    svg += "</svg>\n";
+    out << svg;
+}
+
+
+}
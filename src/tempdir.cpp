@@ -0,0 +1,80 @@
+#include "tempdir.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+
+TempDir::TempDir(const string &parent)
+    : dirname(),
+      files(),
+      mutex()
+{
+    string base = parent.empty() ? TempDir::systemTempDir() : parent;
+    string pattern = base + "/eggp-XXXXXX";
+    vector<char> buffer(pattern.begin(), pattern.end());
+    buffer.push_back('\0');
+
+#ifdef _WIN32
+    if (_mktemp_s(buffer.data(), buffer.size())!=0 || _mkdir(buffer.data())!=0) {
+#else
+    if (mkdtemp(buffer.data())==nullptr) {
+#endif
+        throw runtime_error("Cannot create working directory " + pattern + ": " + strerror(errno));
+    }
+    this->dirname = buffer.data();
+}
+
+TempDir::~TempDir()
+{
+    for (auto it=this->files.begin(); it!=this->files.end(); ++it) {
+        remove(it->c_str());
+    }
+#ifdef _WIN32
+    _rmdir(this->dirname.c_str());
+#else
+    rmdir(this->dirname.c_str());
+#endif
+}
+
+const string &TempDir::path() const
+{
+    return this->dirname;
+}
+
+string TempDir::file(const string &name)
+{
+    string filename = this->dirname + "/" + name;
+    lock_guard<std::mutex> lock(this->mutex);
+    this->files.insert(filename);
+    return filename;
+}
+
+string TempDir::systemTempDir()
+{
+    const char *names[] = {"TMPDIR", "TMP", "TEMP"};
+    for (unsigned i=0; i<sizeof(names)/sizeof(names[0]); ++i) {
+        const char *dir = getenv(names[i]);
+        if (dir!=nullptr && dir[0]!='\0') {
+            return dir;
+        }
+    }
+    return "/tmp";
+}
+
+
+}
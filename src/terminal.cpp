@@ -0,0 +1,189 @@
+#include "terminal.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+    #include <process.h>
+    #define popen  _popen
+    #define pclose _pclose
+    #define getpid _getpid
+#else
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace eggp{
+
+namespace {
+    std::mutex cacheMutex;
+}
+
+string TerminalProbe::cacheFilename;
+
+
+const TerminalProbe &TerminalProbe::instance()
+{
+    //* initialized exactly once, even with concurrent callers
+    static const TerminalProbe probe;
+    return probe;
+}
+
+void TerminalProbe::cacheFile(const string &filename)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    TerminalProbe::cacheFilename = filename;
+}
+
+bool TerminalProbe::hasTerminal(const string &name) const
+{
+    //* substring match as gnuplot's strstrt(), e.g. "cairo" matches "pngcairo"
+    return this->terminalList.find(name) != string::npos;
+}
+
+const string &TerminalProbe::terminals() const
+{
+    return this->terminalList;
+}
+
+const string &TerminalProbe::version() const
+{
+    return this->gnuplotVersion;
+}
+
+TerminalProbe::TerminalProbe()
+    : terminalList(),
+      gnuplotVersion()
+{
+    string filename;
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        filename = TerminalProbe::cacheFilename;
+    }
+
+    string key;
+    if (!filename.empty()) {
+        string path = findExecutable("gnuplot");
+        struct stat st;
+        if (!path.empty() && stat(path.c_str(), &st)==0) {
+            key = path + " " + to_string(static_cast<long long>(st.st_mtime));
+        }
+    }
+
+    if (!key.empty() && readCache(key)) {
+        return;
+    }
+    probe();
+    if (!key.empty() && !this->gnuplotVersion.empty()) {
+        writeCache(key);
+    }
+}
+
+string TerminalProbe::findExecutable(const string &name)
+{
+#ifdef _WIN32
+    const char   separator = ';';
+    const string filename  = name + ".exe";
+#else
+    const char   separator = ':';
+    const string filename  = name;
+#endif
+    const char *env = getenv("PATH");
+    if (env == nullptr) {
+        return "";
+    }
+
+    stringstream ss(env);
+    string dir;
+    while (getline(ss, dir, separator)) {
+        if (dir.empty()) {
+            dir = ".";
+        }
+        string path = dir + "/" + filename;
+        struct stat st;
+        if (stat(path.c_str(), &st)==0 && (st.st_mode & S_IFREG)) {
+            return path;
+        }
+    }
+    return "";
+}
+
+bool TerminalProbe::readCache(const string &key)
+{
+    string filename;
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        filename = TerminalProbe::cacheFilename;
+    }
+
+    ifstream fin(filename.c_str());
+    string cachedKey;
+    if (!getline(fin, cachedKey) || cachedKey != key) {
+        return false;
+    }
+    return static_cast<bool>(getline(fin, this->gnuplotVersion))
+            && static_cast<bool>(getline(fin, this->terminalList));
+}
+
+void TerminalProbe::writeCache(const string &key) const
+{
+    string filename;
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        filename = TerminalProbe::cacheFilename;
+    }
+
+    //* write aside and rename so concurrent processes never read half a file
+    string filenameTmp = filename + ".tmp" + to_string(static_cast<long long>(getpid()));
+    {
+        ofstream fout(filenameTmp.c_str());
+        fout << key << '\n'
+             << this->gnuplotVersion << '\n'
+             << this->terminalList << '\n';
+        if (!fout) {
+            remove(filenameTmp.c_str());
+            return;
+        }
+    }
+    if (rename(filenameTmp.c_str(), filename.c_str()) != 0) {
+        remove(filenameTmp.c_str());
+    }
+}
+
+void TerminalProbe::probe()
+{
+    //* one gnuplot run answers every question; nothing touches the disk
+    const string command = "gnuplot -e \"set print '-'; "
+                           "print GPVAL_VERSION; print GPVAL_PATCHLEVEL; "
+                           "print GPVAL_TERMINALS\"";
+    FILE *pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+        return;
+    }
+
+    string output;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, n);
+    }
+    pclose(pipe);
+
+    stringstream ss(output);
+    string version, patchLevel;
+    if (getline(ss, version) && getline(ss, patchLevel) && getline(ss, this->terminalList)) {
+        this->gnuplotVersion = version + "." + patchLevel;
+    }
+    else {
+        this->terminalList.clear();
+    }
+}
+
+
+}